@@ -2,31 +2,89 @@
  * 程序名称：健身房会员管理系统（链表 + 文件持久化版本）
  *
  * 程序整体功能说明：
- *  1) 会员信息管理：新增会员、修改联系方式（电话）、删除会员（仅限过期/注销）、列表显示
- *  2) 查询功能：按卡号精确查询、按姓名关键字模糊查询
- *  3) 状态管理：自动到期同步（依据系统日期判断）、手动注销/标记过期（处理特殊管理场景）
- *  4) 续费/延长：未到期会员仅允许同类型续费（通过 bonus_days 叠加延长有效期，避免“超长月卡”等类型歧义）；
- *             过期/注销会员允许从今天重新购买任意类型
- *  5) 统计分析：有效会员数量、类型占比、30天内到期提醒
+ *  1) 会员信息管理：新增会员、修改联系方式（电话）、删除会员（仅限过期/注销）、列表显示（可按姓名/到期日/入会日期/类型排序）
+ *  2) 查询功能：按卡号精确查询、按姓名关键字模糊查询（不区分大小写与全角/半角）、多条件组合查询（如 status=active type=年卡 age=20-30）
+ *  3) 状态管理：到期状态按缓存的到期日实时判定（只读，不回写数据）、手动注销/标记过期（处理特殊管理场景）
+ *  4) 续费/延长：未到期会员仅允许同类型续费（通过 renew_periods 累加续费周期数延长有效期，避免“超长月卡”等类型歧义）；
+ *             过期/注销会员允许从今天重新购买任意类型；支持从文件批量续费（一次校验、一次保存）
+ *  5) 统计分析：有效会员数量、类型占比、30天内到期提醒、最近到期的前 K 名会员（按剩余天数排序）
  *  6) 数据持久化：启动读取 members.txt；增删改/续费后写回文件；退出时再次保存
+ *  7) 分页浏览：按卡号顺序分页显示，支持上一页/下一页与按卡号跳转
+ *  8) 续费提醒：按 7/30/90 天等窗口列出即将到期会员，可导出到 reminders.txt
+ *  9) 到期调度：跨过午夜时找出当天到期的会员，向订阅者发出到期事件（控制台提示 + expiry.log）
+ * 10) 剩余天数分布：按周/按月统计有效会员剩余天数及类型构成（由日桶计数增量维护）
+ * 11) 数据导出：全部会员、组合查询结果、统计报表导出为 CSV 或 JSON Lines（流式写出，内存占用恒定）
+ * 12) 批处理：gym --batch <文件|-> 逐行执行 JSON Lines 操作，每行输出一个 JSON 结果，结束时统一保存
+ * 13) 输出格式：gym --output <table|plain|machine> 选择对齐表格、纯文本或 JSON Lines（列表/查询/统计界面共用）
+ * 14) 实时统计看板：开启后每次操作只显示变化的有效人数、类型构成与 30 天内到期清单（由会员变更通知增量维护）
  *
  * 数据文件格式（文本，UTF-8）：每行一个会员记录，字段用 '|' 分隔：
- *  card_id|name|gender|age|phone|join_date|membership_type|is_active|bonus_days
+ *  card_id|name|gender|age|phone|join_date|membership_type|is_active|bonus_days|renew_periods
  *
  * 说明：
- *  - Member 保存会员基础信息；Node 结点额外保存 bonus_days（同类型续费累计延长天数）
+ *  - 有效期按自然月计算：月卡 1 个月、季卡 3 个月、年卡 12 个月（如 01-31 起的月卡到 02-28/29），
+ *    到期日 = 入会日 + 套餐月数 ×（1 + renew_periods）个自然月 + bonus_days，
+ *    总月数始终从入会日起算，连续续费不会因月末截断而逐次提前（01-31 → 02-28 → 03-31）；
+ *    在写入（新增/续费/加载）时算出到期日天数并缓存，扫描路径只做整数比较
+ *  - 旧格式（只有 9 个字段、无 renew_periods）的记录按固定天数（30/90/365）计算有效期，
+ *    加载时换算为 bonus_days 的天数差，保持原到期日不变；下次保存即写为新格式
+ *  - Member 保存会员基础信息；Node 结点额外保存 renew_periods（同类型续费次数）、bonus_days（额外天数）、
+ *    expire_day（到期日天数，写入时计算）与 name_key（姓名折叠后的检索键，创建结点时计算一次）
+ *  - 会员“有效”= is_active==1（未被手动注销）且 expire_day >= 今天；到期不修改 is_active
+ *  - card_index 按卡号升序保存结点指针：卡号查找与分页跳转均为二分查找 O(log n)
+ *  - expiry_buckets 为 366 个按到期日取模的日桶（环形），提醒与调度只访问窗口内的日桶
+ *  - expire_col 与 card_index 逐位对齐保存到期日（已注销为 INT32_MIN），供 SIMD 批量判定有效状态
+ *  - 基准测试：gcc -O2 -DGYM_BENCH final.c 编译后运行 ./a.out --bench <名称>（见文件末尾基准测试部分）
  *  - 写文件使用临时文件 members.tmp，写入成功后覆盖 members.txt，降低写入中断造成数据损坏风险
+ *  - members.bloom 保存“所有发放过的卡号”布隆过滤器：内存中查不到的卡号，可直接判定“从未发放”；
+ *    位图按最大已发放卡号（已发放数量的上界）每个卡号约 10 位取 2 的幂，卡号增长时扩容重建，误判率不超过约 1.2%
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <errno.h>
 #include <stdint.h>
 
-#define MAX_MEMBERS 100
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define MAX_MEMBERS 1000000      /* 会员数上限：与基准测试规模一致，索引/日桶/排序排列均按此规模设计 */
 #define DATA_FILE "members.txt"
 #define TEMP_FILE "members.tmp"
+#define EXPIRY_LOG_FILE "expiry.log"
+#define REMINDER_FILE "reminders.txt"
+#define EXPIRY_RING_DAYS 366     /* 到期日桶环大小：覆盖一年内任意窗口 */
+#define MEMBER_TYPES 3           /* 会员类型数：月卡/季卡/年卡 */
+#define HIST_WEEKS 53            /* 分布报表：按周分组数（0~365 天） */
+#define HIST_MONTHS 13           /* 分布报表：按月（30 天）分组数 */
+#define MAX_EXPIRY_LISTENERS 4   /* 到期事件订阅者上限 */
+#define MAX_CHANGE_LISTENERS 4   /* 会员变更通知订阅者上限 */
+#define DASH_WINDOW 30           /* 统计看板到期清单窗口（天） */
+#define DASH_LIST_MAX 20         /* 统计看板到期清单最多显示人数 */
+#define BLOOM_FILE "members.bloom"
+#define BLOOM_TEMP_FILE "members.bloom.tmp"
+#define BLOOM_MIN_BITS (1u << 16)   /* 布隆过滤器最小位数（8KB） */
+#define BLOOM_MAX_BITS (1u << 27)   /* 布隆过滤器最大位数（16MB，约 1300 万卡号），超过后不再扩容 */
+#define BLOOM_BITS_PER_KEY 10       /* 每个卡号分配的位数：4 个散列时满载误判率约 1.2% */
+#define BLOOM_HASHES 4              /* 每个卡号设置的位数 */
+#define BLOOM_LEGACY_BYTES 8192     /* 旧格式布隆过滤器文件：无文件头的 8KB 位图 */
+#define BLOOM_LEGACY_SCAN (1 << 20) /* 合并旧格式文件时枚举的卡号上限 */
+#define PAGE_SIZE 20             /* 分页浏览每页显示行数 */
+#define ROW_CACHE_MAX 512        /* 单行表格排版结果上限（字节），超过则不缓存 */
+#define MAX_QUERY_PREDS 8        /* 组合查询最多条件数 */
+#define DEFAULT_TOP_K 50         /* 最近到期查询默认人数 */
+#define MAX_BATCH_REJECTS 200    /* 批量续费最多逐条列出的拒绝记录数 */
+#define BATCH_LINE_MAX 1024      /* 批处理输入单行最大长度 */
+#define BATCH_VALUE_MAX 256      /* 批处理 JSON 单个值最大长度（查询条件需与交互输入一致） */
+#define MAX_JSON_FIELDS 12       /* 批处理 JSON 对象最多键值对数 */
+#define INPUT_LINE_MAX 1024      /* 交互输入单行最大长度（超出部分丢弃） */
+#define EXPORT_CSV_FILE "members.csv"
+#define EXPORT_JSONL_FILE "members.jsonl"
 
 /* 表格列宽（按“视觉宽度”计；用于中英文混排对齐输出） */
 #define W_CARD   8
@@ -39,6 +97,19 @@
 #define W_STATUS 8
 #define W_LEFT   10
 
+#define OUT_BUF_SIZE 32768       /* 输出缓冲区大小（保存/导出按块写出） */
+
+/*
+ * 输出缓冲区：格式化结果先写入 data，满了再整块 fwrite 到 fp
+ * error 记录写入失败，调用方在结束时统一检查
+ */
+typedef struct {
+    FILE* fp;
+    size_t len;
+    int error;
+    char data[OUT_BUF_SIZE];
+} OutBuf;
+
 /* 会员基本信息结构体 */
 typedef struct {
     int card_id;                 /* 会员卡号（唯一） */
@@ -48,83 +119,490 @@ typedef struct {
     char phone[15];              /* 手机号：11位数字 */
     char join_date[12];          /* 入会日期：YYYY-MM-DD */
     char membership_type[10];    /* 会员类型：月卡/季卡/年卡 */
-    int is_active;               /* 状态：1=有效，0=过期/注销 */
+    int is_active;               /* 存储状态：1=未注销，0=已注销（或旧数据中已到期） */
 } Member;
 
 /*
  * 链表节点结构体：
  *  - data 保存会员基础信息
- *  - bonus_days 保存同类型续费累计延长天数（用于延长有效期而不改变会员类型含义）
+ *  - renew_periods 保存同类型续费次数（每次顺延一个套餐周期，不改变会员类型含义）
+ *  - bonus_days 保存额外延长天数（旧格式记录换算而来，新续费不再修改）
+ *  - join_day/expire_day 缓存入会日期与到期日天数：入会日期/类型/renew_periods/bonus_days 变化时重新计算，
+ *    读取路径（查询、排序、到期判定）只做整数比较
+ *  - bucket_prev/bucket_next/bucket_slot 将未注销且未到期的会员挂入到期日桶（bucket_slot=-1 表示未挂入）；
+ *    bucket_type/bucket_far 记录挂入时计入的类型与“窗口外”标记，摘除时据此回退计数
+ *  - name_key 保存姓名的检索键：全角 ASCII 转半角、拉丁字母转小写；
+ *    折叠只会缩短或保持字节长度，因此与 name 同长即可
+ *  - name_cut/name_cut_width 保存姓名按 W_NAME 截断的字节数及截断后的显示宽度，
+ *    表格输出时直接复制 name_cut 字节并补齐空格，无需再逐字解码
+ *  - row_cache/row_len/row_day 缓存已排版好的表格行（含换行）：剩余天数依赖今天，
+ *    因此 row_day 与今天不同即失效；会员信息变化时置 row_day = -1
+ *  - sort_expire/sort_joined/sort_type 为结点在排序排列中所处位置对应的键值：
+ *    排列只按这组键比较，键值变化时先按旧键定位摘除，再更新键值重新插入
+ *  - dash_type/dash_window 为统计看板中该会员计入的有效类型（-1 表示未计入）与“窗口内到期”标记，
+ *    变更时据此回退旧计数
  */
 typedef struct Node {
     Member data;
+    int renew_periods;
     long bonus_days;
+    long join_day;
+    long expire_day;
+    char name_key[30];
+    unsigned char name_cut;
+    unsigned char name_cut_width;
+    char* row_cache;
+    int row_len;
+    long row_day;
+    long sort_expire;
+    long sort_joined;
+    signed char sort_type;
+    signed char dash_type;
+    signed char dash_window;
+    struct Node* bucket_prev;
+    struct Node* bucket_next;
+    int bucket_slot;
+    signed char bucket_type;
+    signed char bucket_far;
     struct Node* next;
 } Node;
 
+/* 组合查询字段：枚举顺序即单条件求值代价由低到高的参考顺序 */
+typedef enum {
+    Q_AGE,          /* 整数比较 */
+    Q_GENDER,       /* 短字符串比较 */
+    Q_TYPE,         /* 短字符串比较 */
+    Q_JOINED,       /* 整数比较（缓存的入会日天数） */
+    Q_STATUS,       /* 需计算到期日 */
+    Q_NAME          /* 子串搜索 */
+} QueryField;
+
+/* 单个查询条件：数值/日期字段使用闭区间 [lo, hi]，文本字段使用 text */
+typedef struct {
+    QueryField field;
+    long lo, hi;
+    char text[30];
+} QueryPred;
+
+/*
+ * 编译后的查询：
+ *  - preds 按求值代价升序排列，逐条短路求值
+ *  - 卡号条件不进入 preds，而是转换为 card_index 上的扫描区间 [card_lo, card_hi]
+ */
+typedef struct {
+    QueryPred preds[MAX_QUERY_PREDS];
+    int count;
+    int card_lo, card_hi;
+    long today;
+} Query;
+
+/* 到期排序条目：剩余天数 + 会员结点（用于前 K 名最近到期查询） */
+typedef struct {
+    long days_left;
+    Node* node;
+} ExpiryEntry;
+
+/* 剩余天数分布：按周/按月分组，每组再按类型（月卡/季卡/年卡）计数；beyond 为超过 365 天 */
+typedef struct {
+    int week[HIST_WEEKS][MEMBER_TYPES];
+    int month[HIST_MONTHS][MEMBER_TYPES];
+    int beyond[MEMBER_TYPES];
+} ExpiryHistogram;
+
+/* 导出格式 */
+typedef enum {
+    EXPORT_CSV,             /* 逗号分隔，首行为列名 */
+    EXPORT_JSONL            /* JSON Lines：每行一个 JSON 对象 */
+} ExportFormat;
+
+/* 列表排序方式：LIST_INSERTION 为录入顺序（链表顺序），其余各有一份排序排列 */
+typedef enum {
+    LIST_INSERTION,
+    LIST_BY_NAME,           /* 姓名检索键，同名按卡号 */
+    LIST_BY_EXPIRY,         /* 到期日，同日按卡号 */
+    LIST_BY_JOINED,         /* 入会日期，同日按卡号 */
+    LIST_BY_TYPE_EXPIRY,    /* 类型（月卡/季卡/年卡）再按到期日、卡号 */
+    LIST_ORDERS
+} ListOrder;
+
+/* 会员表格视图：完整列（列表/分页/组合查询）与简表（姓名搜索：卡号、姓名、类型、状态） */
+typedef enum {
+    VIEW_FULL,
+    VIEW_BRIEF
+} MemberView;
+
+/*
+ * 输出后端：各显示界面只通过这组回调输出，回调写入调用方传入的同一个输出缓冲区
+ *  - title/note：标题与提示文字（机器可读输出忽略）
+ *  - error：错误信息（查无此卡、内存分配失败等；机器可读输出写为一行 {"error":...}）
+ *  - tableBegin/memberRow/tableEnd：会员表格（表头、逐行、表尾）
+ *  - memberDetail：单个会员详情（按卡号查询）
+ *  - reportBegin/reportSection/reportCount/reportMember/reportEnd：统计报表的分节、计数项与到期会员；
+ *    reportCount 的 metric/type 供机器可读输出使用，label 供人阅读（type 非 NULL 时为分类计数）
+ */
+typedef struct {
+    const char* name;
+    void (*title)(OutBuf* ob, const char* text);
+    void (*note)(OutBuf* ob, const char* text);
+    void (*error)(OutBuf* ob, const char* text);
+    void (*tableBegin)(OutBuf* ob, MemberView view);
+    void (*memberRow)(OutBuf* ob, Node* p, MemberView view, long today);
+    void (*tableEnd)(OutBuf* ob, MemberView view);
+    void (*memberDetail)(OutBuf* ob, const Node* p, long today);
+    void (*reportBegin)(OutBuf* ob, const char* title, const char* date);
+    void (*reportSection)(OutBuf* ob, const char* title);
+    void (*reportCount)(OutBuf* ob, const char* metric, const char* type, const char* label, long value, long total);
+    void (*reportMember)(OutBuf* ob, const Node* p, long days_left);
+    void (*reportEnd)(OutBuf* ob);
+} OutputBackend;
+
+/* 会员变更类型（变更通知） */
+typedef enum {
+    CHANGE_ADDED,           /* 新增（含加载） */
+    CHANGE_UPDATED,         /* 到期日、注销状态或联系方式变化 */
+    CHANGE_REMOVED,         /* 即将删除（回调返回后结点被释放） */
+    CHANGE_CLEARED          /* 全部会员被释放（结点参数为 NULL） */
+} ChangeKind;
+
+/* 统计看板到期清单条目：保存显示时的副本，会员被删除后仍可输出差异 */
+typedef struct {
+    int card_id;
+    long days_left;
+    char name[30];
+} DashEntry;
+
+/*
+ * 实时统计看板：
+ *  - day/active/expiring 为模型：当前有效人数（按类型）与窗口内到期人数，由变更通知逐条增量维护
+ *  - dirty/list_dirty 标记上次刷新后是否有变更、到期清单是否可能变化
+ *  - shown_* 为上次显示的数值与清单，刷新时与模型比较，只输出变化的项
+ */
+typedef struct {
+    int enabled;
+    int subscribed;
+    long day;
+    int active[MEMBER_TYPES];
+    int expiring;
+    int dirty;
+    int list_dirty;
+    int shown_active[MEMBER_TYPES];
+    int shown_expiring;
+    DashEntry shown[DASH_LIST_MAX];
+    int shown_count;
+} Dashboard;
+
+/* 交互输入读取结果 */
+typedef enum {
+    INPUT_EOF = -1,         /* 输入结束（管道关闭或 Ctrl+D/Ctrl+Z） */
+    INPUT_INVALID = 0,      /* 格式不符，当前行剩余内容已丢弃 */
+    INPUT_OK = 1
+} InputResult;
+
+/* 续费规则判定结果 */
+typedef enum {
+    RENEW_RESTARTED,        /* 过期/注销：从今天重新生效 */
+    RENEW_EXTENDED,         /* 未到期：同类型延长 */
+    RENEW_TYPE_MISMATCH     /* 未到期且类型不同：拒绝 */
+} RenewResult;
+
 /* 全局链表指针与计数器（链表存储全部会员数据） */
 static Node* head = NULL;
 static Node* tail = NULL;
 static int member_count = 0;
 static int next_card_id = 1001;
 
+/*
+ * 卡号有序索引：card_index[0..member_count-1] 按 card_id 升序排列
+ *  - 新卡号自增生成，追加时通常直接落在末尾（O(1)）
+ *  - 分页游标记录“本页首行卡号”，翻页时二分定位，增删会员后游标依然稳定
+ */
+static Node** card_index = NULL;
+static int card_index_cap = 0;
+
+/* 到期日列：expire_col[i] 对应 card_index[i]，容量与 card_index 同步 */
+static int32_t* expire_col = NULL;
+
+/*
+ * 排序排列：sort_perm[order][0..member_count-1] 为按该方式排好序的结点指针
+ *  - 首次按某方式列表时整体排序一次（O(n log n)），之后随增删改增量维护（二分定位 + 整段搬移）
+ *  - NULL 表示尚未建立；维护失败（内存不足）时丢弃该排列，下次使用时重建
+ */
+static Node** sort_perm[LIST_ORDERS];
+static int sort_perm_cap[LIST_ORDERS];
+
+/*
+ * 到期日桶环：expiry_buckets[day % EXPIRY_RING_DAYS] 为该日到期会员的双向链表头
+ *  - ring_base_day 为桶环当前基准日（由调度器推进），窗口为 [ring_base_day, ring_base_day + 365]
+ *  - ring_counts[槽位][类型] 统计窗口内各日到期人数；ring_far_counts 统计窗口之后到期的人数
+ */
+static Node* expiry_buckets[EXPIRY_RING_DAYS];
+static long ring_base_day = 0;
+static int ring_counts[EXPIRY_RING_DAYS][MEMBER_TYPES];
+static int ring_far_counts[MEMBER_TYPES];
+
+/* 实时统计看板（菜单开启后由变更通知维护） */
+static Dashboard dashboard;
+
+/*
+ * 已发放卡号布隆过滤器：只增不减，删除会员后仍保留其卡号
+ *  - bloom_bits 为位图位数（2 的幂，0 表示尚未分配）
+ *  - bloom_max_id 为记录过的最大卡号：大于它的卡号一定从未发放，扩容重建时枚举 1..bloom_max_id
+ */
+static uint8_t* issued_bloom = NULL;
+static uint32_t bloom_bits = 0;
+static int bloom_max_id = 0;
+
 /* ======= 菜单与业务函数声明 ======= */
 void printMainMenu();
 void printManageMenu();
 void printSearchMenu();
 
 void showAllMembers();
+void listMembers(ListOrder order);  /* 按录入顺序/姓名/到期日/入会日期/类型+到期日列表 */
+void showMembersPaged();          /* 分页浏览（卡号顺序） */
 void addMember();
 void updateMemberPhone();
 void deleteExpiredMember();
 void renewMember();               /* 续费/延长 */
+void renewFromFile();             /* 批量续费（从文件读取 卡号|类型） */
 void searchByCardID();
 void searchByName();
 void updateMemberStatus();        /* 手动注销/过期标记（不可逆） */
+void queryMembers();              /* 多条件组合查询 */
 void showStatistics();
-
-/* ======= 输入清理、校验、日期计算 ======= */
-void clearInputBuffer();
+void showSoonestExpiring();       /* 最近到期前 K 名 */
+void showRenewalReminders();      /* 按窗口续费提醒（可导出） */
+void exportData();                /* 导出会员/查询结果/统计到 CSV 或 JSON Lines */
+void toggleDashboard();           /* 开启/关闭实时统计看板 */
+void dashboardTick();             /* 看板刷新：只输出上次刷新后变化的数值 */
+int runBatch(const char* path);   /* 批处理命令模式（JSON Lines 输入，每行一个结果） */
+int selectOutputBackend(const char* name);   /* 按名称（table/plain/machine）切换输出后端 */
+static void outputError(const char* text);   /* 经当前输出后端写出一条错误信息 */
+
+/* ======= 输入读取、校验、日期计算 ======= */
+int inputToken(char* out, size_t size);  /* 读取下一个词（以空白分隔，可跨行） */
+int inputInt(int* out);                  /* 读取下一个词并按十进制整数解析 */
+int inputLine(char* out, size_t size);   /* 读取一整行（当前行剩余部分为空白时读下一行） */
+void inputDiscardLine();                 /* 丢弃当前行剩余内容 */
 void getSystemDate(char *buffer);
 
+/* ======= 日期时钟服务：缓存“今天”，跨日才重新计算 ======= */
+long clockToday();                       /* 今日在累计天数轴上的位置 */
+const char* clockTodayStr();             /* 与最近一次 clockToday 对应的 YYYY-MM-DD */
+void clockSetFixed(long days);           /* 注入固定日期（测试/基准）；传 0 恢复系统时钟 */
+
 int isValidAge(int age);
 int isValidPhone(const char *phone);
 
 long dateToDays(const char* date);       /* 含闰年处理 */
+void daysToDate(long days, char* buffer);   /* dateToDays 的逆运算，输出 YYYY-MM-DD */
 int getDurationDays(const char* type);
+int getDurationMonths(const char* type);
+long addMonthsToDays(long days, int months);  /* 按自然月推进，月末日期自动截到目标月最后一天 */
 
-void syncAutoExpire();                   /* 自动到期同步 */
+static int isMemberActive(const Node* p, long today);   /* 派生状态：未注销且未到期 */
 
 /* ======= UTF-8 对齐输出辅助函数 ======= */
 void printWithPad(const char *str, int target_width);
 void printSeparator();
 static uint32_t utf8_decode(const char *s, int *bytes);
 static int char_width(uint32_t u);
-static int is_cjk_wide(uint32_t u);
+static void initWidthTable();
+static size_t asciiPrefixLen(const char* s, size_t n);
+static int measureText(const char* s, int limit, int* cut_bytes, int* cut_width);
+static void foldNameKey(const char* src, char* dst, size_t dst_size);
+
+/* ======= 定长格式化与缓冲输出 ======= */
+static char* fmtLong(char* dst, long v);
+static void obInit(OutBuf* ob, FILE* fp);
+static int obFlush(OutBuf* ob);
+static void obWrite(OutBuf* ob, const char* s, size_t n);
+static void obPutc(OutBuf* ob, char c);
+static void obPuts(OutBuf* ob, const char* s);
+static void obLong(OutBuf* ob, long v);
+static void obPad(OutBuf* ob, int n);
+static void obAsciiPad(OutBuf* ob, const char* s, size_t len, int target_width);
+static void obTextPad(OutBuf* ob, const char* s, int target_width);
+static void obSeparator(OutBuf* ob);
+static void obNameCell(OutBuf* ob, const Node* p);
 
 /* ======= 链表与文件持久化辅助函数 ======= */
 Node* createNode(const Member* m);
-void appendNode(Node* node);
+int appendNode(Node* node);
 Node* findByCardID(int id);
+static int cardIndexLowerBound(int id);
+static int cardIndexInsert(Node* node);
+static void cardIndexRemove(int id);
+static void refreshExpiryIndexes(Node* p);
+static void invalidateRowCache(Node* p);
+static Node** sortPermGet(ListOrder order);
+static void sortPermInsert(Node* p);
+static void sortPermRemove(Node* p);
+static void sortPermReposition(Node* p);
+static void sortPermFreeAll();
+static void freeNode(Node* p);
 void freeAllMembers();
 
 int loadFromFile(const char* filename);
 int saveToFile(const char* filename);
 
+/* ======= 已发放卡号布隆过滤器 ======= */
+void bloomAdd(int id);
+int bloomMayContain(int id);
+int loadBloom(const char* filename);
+int saveBloom(const char* filename);
+static void reportCardNotFound(int id);
+static const char* cardNotFoundReason(int id);
+
+/* ======= 组合查询引擎 ======= */
+int compileQuery(const char* text, long today, Query* q, char* err, size_t err_size);
+int runQuery(const Query* q, void (*visit)(Node* p, void* ctx), void* ctx);
+
+/* ======= 流式导出（CSV / JSON Lines） ======= */
+long exportMembers(FILE* fp, ExportFormat fmt, const Query* q, long today);   /* q 为 NULL 时导出全部 */
+long exportStatistics(FILE* fp, ExportFormat fmt, long today);
+static int countActiveByType(long today, int by_type[MEMBER_TYPES]);
+
+/* ======= 到期排序查询 ======= */
+int topKExpiring(long today, int k, ExpiryEntry* out);
+
+/* ======= 批量到期判定（SIMD） ======= */
+long bulkEvalActive(const int32_t* expire, size_t n, int32_t today, uint64_t* bitmap);
+static int ctz64(uint64_t x);
+
+/* ======= 到期日桶环：续费提醒与到期调度 ======= */
+static void bucketLink(Node* p);
+static void bucketUnlink(Node* p);
+int forEachExpiring(long today, int window, void (*visit)(Node* p, long days_left, void* ctx), void* ctx);
+static void ringAdvance(long new_base, void (*on_expire)(const Node* p));
+static void ringRebuild(long base);
+static int memberTypeIndex(const char* type);
+void buildHistogramIncremental(long today, ExpiryHistogram* h);
+void buildHistogramScan(long today, ExpiryHistogram* h);
+void showExpiryHistogram();       /* 剩余天数分布报表 */
+
+/* ======= 到期调度器：跨日时发出到期事件 ======= */
+typedef void (*ExpiryListener)(const Node* p, long expire_day, void* ctx);
+int expirySubscribe(ExpiryListener fn, void* ctx);
+void schedulerTick();
+
+/* ======= 会员变更通知：增删改时通知订阅者 ======= */
+typedef void (*ChangeListener)(ChangeKind kind, Node* p, void* ctx);
+int changeSubscribe(ChangeListener fn, void* ctx);
+static void emitChange(ChangeKind kind, Node* p);
+
 /* ======= 初次运行测试数据 ======= */
 void initTestData();
 
-/* 计算会员到期日（累计：入会日期 + 套餐天数 + bonus_days） */
-static long calcExpireDays(Node* p);
+/* 会员到期日：calcExpireDays 读取缓存，updateExpireDay 在写入时重新计算 */
+static long calcExpireDays(const Node* p);
+static void updateExpireDay(Node* p);
 
 /* =========================================================
- *  输入缓冲清理与合法性校验
+ *  输入读取与合法性校验
+ *  目的：所有提示共用一个行缓冲读取器，按行 fgets 读入后在缓冲区内切词、解析整数，
+ *       不经过 scanf 的格式串解析；管道批量输入时按 stdio 块读取
+ *  规则：
+ *   - 词以空格/制表符分隔，可跨行读取（同一行可连续回答多个提示）
+ *   - 整数必须整个词都是十进制数字（可带符号），否则判为非法并丢弃当前行剩余内容，
+ *     错误输入不会残留到下一个提示
+ *   - 超过 INPUT_LINE_MAX 的行只保留前段；超过目标缓冲区的词判为非法（同样丢弃当前行），不截断后使用
+ *   - 输入结束后所有读取返回 INPUT_EOF，调用方据此放弃当前操作
  * ========================================================= */
 
-/* 清理输入缓冲区：用于处理 scanf 读入失败或残留的换行符 */
-void clearInputBuffer() {
-    int c;
-    while ((c = getchar()) != '\n' && c != EOF);
+static char input_line[INPUT_LINE_MAX];
+static size_t input_pos = 0;      /* 当前行读取位置 */
+static size_t input_len = 0;      /* 当前行长度（不含换行） */
+static int input_has_line = 0;    /* 0 表示需要读取下一行 */
+
+/* inputFill：读入下一行到 input_line，去掉行尾换行；过长的行丢弃剩余部分。输入结束返回 0 */
+static int inputFill() {
+    if (!fgets(input_line, sizeof(input_line), stdin)) {
+        input_has_line = 0;
+        return 0;
+    }
+    size_t n = strlen(input_line);
+    if (n > 0 && input_line[n - 1] == '\n') {
+        n--;
+    } else {
+        int c;
+        while ((c = getchar()) != '\n' && c != EOF);
+    }
+    if (n > 0 && input_line[n - 1] == '\r') n--;
+    input_line[n] = '\0';
+    input_len = n;
+    input_pos = 0;
+    input_has_line = 1;
+    return 1;
+}
+
+static int isInputSpace(char c) {
+    return c == ' ' || c == '\t';
+}
+
+/* inputDiscardLine：丢弃当前行剩余内容，下一次读取从新的一行开始 */
+void inputDiscardLine() {
+    input_has_line = 0;
+}
+
+/* inputToken：读取下一个词到 out；词长超出 out 容量时返回 INPUT_INVALID 并丢弃当前行 */
+int inputToken(char* out, size_t size) {
+    for (;;) {
+        if (!input_has_line && !inputFill()) return INPUT_EOF;
+        while (input_pos < input_len && isInputSpace(input_line[input_pos])) input_pos++;
+        if (input_pos < input_len) break;
+        input_has_line = 0;
+    }
+
+    size_t start = input_pos;
+    while (input_pos < input_len && !isInputSpace(input_line[input_pos])) input_pos++;
+    size_t n = input_pos - start;
+    if (n >= size) {
+        out[0] = '\0';
+        inputDiscardLine();
+        return INPUT_INVALID;
+    }
+    memcpy(out, input_line + start, n);
+    out[n] = '\0';
+    return INPUT_OK;
+}
+
+/* inputInt：读取一个整数（可带正负号，不得含其他字符且不得超出 int 范围） */
+int inputInt(int* out) {
+    char tok[24];
+    int rc = inputToken(tok, sizeof(tok));
+    if (rc != INPUT_OK) return rc;
+
+    const char* s = tok;
+    int neg = (*s == '-');
+    if (*s == '-' || *s == '+') s++;
+    if (!*s) { inputDiscardLine(); return INPUT_INVALID; }
+
+    int64_t v = 0;
+    for (; *s; s++) {
+        if (*s < '0' || *s > '9') { inputDiscardLine(); return INPUT_INVALID; }
+        v = v * 10 + (*s - '0');
+        if (v > INT32_MAX + (int64_t)neg) { inputDiscardLine(); return INPUT_INVALID; }
+    }
+    if (neg) v = -v;
+    *out = (int)v;
+    return INPUT_OK;
+}
+
+/* inputLine：读取一行文本；上一个词之后本行还有内容时取剩余部分，否则读取下一行 */
+int inputLine(char* out, size_t size) {
+    if (input_has_line) {
+        while (input_pos < input_len && isInputSpace(input_line[input_pos])) input_pos++;
+        if (input_pos >= input_len) input_has_line = 0;
+    }
+    if (!input_has_line && !inputFill()) return INPUT_EOF;
+
+    size_t n = input_len - input_pos;
+    if (n >= size) n = size - 1;
+    memcpy(out, input_line + input_pos, n);
+    out[n] = '\0';
+    input_has_line = 0;
+    return INPUT_OK;
 }
 
 /* 年龄合法性校验：要求 18~80 岁 */
@@ -142,11 +620,10 @@ int isValidPhone(const char *phone) {
     return 1;
 }
 
-/* 获取系统当前日期，格式：YYYY-MM-DD（用于自动到期同步与默认入会日期生成） */
+/* 获取系统当前日期，格式：YYYY-MM-DD（用于默认入会日期生成；取自时钟服务缓存） */
 void getSystemDate(char *buffer) {
-    time_t t = time(NULL);
-    struct tm *tm_info = localtime(&t);
-    sprintf(buffer, "%04d-%02d-%02d", tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday);
+    clockToday();
+    strcpy(buffer, clockTodayStr());
 }
 
 /* =========================================================
@@ -154,44 +631,152 @@ void getSystemDate(char *buffer) {
  *  目的：保证天数差值等于真实天数差，用于跨月/跨年到期计算
  * ========================================================= */
 
+/* 平年每月天数，以及每月 1 日之前的累计天数（下标为月份 1~12） */
+static const int month_days[13] = {0,31,28,31,30,31,30,31,31,30,31,30,31};
+static const int cum_month_days[13] = {0,0,31,59,90,120,151,181,212,243,273,304,334};
+
+/* isLeapYear：按位与组合条件，避免短路分支 */
 static int isLeapYear(int y) {
-    return (y % 4 == 0 && y % 100 != 0) || (y % 400 == 0);
+    return ((y & 3) == 0) & ((y % 100 != 0) | (y % 400 == 0));
 }
 
 static int daysInMonth(int y, int m) {
-    static const int mdays[] = {0,31,28,31,30,31,30,31,31,30,31,30,31};
-    if (m == 2) return mdays[m] + (isLeapYear(y) ? 1 : 0);
-    return mdays[m];
+    return month_days[m] + ((m == 2) & isLeapYear(y));
+}
+
+/* yearStartDays：y 年 1 月 0 日在累计天数轴上的位置（y*365 + 0..y-1 年的闰年数） */
+static long yearStartDays(long y) {
+    long y1 = y - 1;
+    return y * 365 + y1 / 4 - y1 / 100 + y1 / 400;
+}
+
+/* parseDigits：解析固定位置的 n 位十进制数字；含非数字字符时返回 -1 */
+static int parseDigits(const char* s, int n) {
+    int v = 0;
+    for (int i = 0; i < n; i++) {
+        unsigned dgt = (unsigned)(s[i] - '0');
+        if (dgt > 9) return -1;
+        v = v * 10 + (int)dgt;
+    }
+    return v;
 }
 
 /*
- * dateToDays：日期字符串 -> 累计天数
+ * dateToDays：日期字符串 -> 累计天数（非法日期返回 0）
  * 关键语句说明：
- *  - 先累加整年天数 + 闰年修正
- *  - 再累加月份天数
- *  - 最后加上当月日
+ *  - 标准格式 YYYY-MM-DD 按固定位置直接取数字，不经过 sscanf
+ *  - 整年天数 + 闰年修正，加上累计月天数表（3 月起闰年补 1 天），最后加上当月日
+ *  - 非标准写法（如 2026-1-5）退回 sscanf 解析，兼容手工编辑的数据文件
  */
 long dateToDays(const char* date) {
-    int y, m, d;
-    if (sscanf(date, "%d-%d-%d", &y, &m, &d) != 3) return 0;
+    int y, m = -1, d = -1;
+    /* 逐段校验后再读取下一段，短字符串不会越过结尾 '\0' */
+    if ((y = parseDigits(date, 4)) >= 0 && date[4] == '-' &&
+        (m = parseDigits(date + 5, 2)) >= 0 && date[7] == '-' &&
+        (d = parseDigits(date + 8, 2)) >= 0 && date[10] == '\0') {
+        /* 标准格式，已按固定位置解析 */
+    } else if (sscanf(date, "%d-%d-%d", &y, &m, &d) != 3) {
+        return 0;
+    }
     if (m < 1 || m > 12) return 0;
     if (d < 1 || d > daysInMonth(y, m)) return 0;
 
-    long days = 0;
+    return yearStartDays(y) + cum_month_days[m] + ((m > 2) & isLeapYear(y)) + d;
+}
+
+/* daysToYMD：累计天数 -> 年/月/日 */
+static void daysToYMD(long days, long* year, int* month, int* day) {
+    long y = days * 400 / 146097;
+    while (yearStartDays(y + 1) < days) y++;
+    while (yearStartDays(y) >= days) y--;
 
-    /* 计算 0..(y-1) 年中闰年的数量，用于修正累计天数 */
-    long y1 = y - 1;
-    long leapCount = y1 / 4 - y1 / 100 + y1 / 400;
+    int doy = (int)(days - yearStartDays(y));          /* 1..366 */
+    int leap = isLeapYear((int)y);
+    int m = doy / 32 + 1;                               /* 估算值，至多偏小 1 */
+    if (m < 12 && doy > cum_month_days[m + 1] + ((m + 1 > 2) & leap)) m++;
 
-    days += (long)y * 365 + leapCount;
+    *year = y;
+    *month = m;
+    *day = doy - cum_month_days[m] - ((m > 2) & leap);
+}
 
-    for (int i = 1; i < m; i++) days += daysInMonth(y, i);
+/*
+ * daysToDate：累计天数 -> YYYY-MM-DD（dateToDays 的逆运算）
+ * 关键语句说明：
+ *  - 年月日由 daysToYMD 求出：先按 400 年周期（146097 天）估算年份，再最多修正一次；
+ *    年内序号通过累计月天数表反查月份
+ *  - 按固定位置逐位写入，不经过 sprintf
+ */
+void daysToDate(long days, char* buffer) {
+    long y;
+    int m, d;
+    daysToYMD(days, &y, &m, &d);
+
+    buffer[0] = (char)('0' + y / 1000 % 10);
+    buffer[1] = (char)('0' + y / 100 % 10);
+    buffer[2] = (char)('0' + y / 10 % 10);
+    buffer[3] = (char)('0' + y % 10);
+    buffer[4] = '-';
+    buffer[5] = (char)('0' + m / 10);
+    buffer[6] = (char)('0' + m % 10);
+    buffer[7] = '-';
+    buffer[8] = (char)('0' + d / 10);
+    buffer[9] = (char)('0' + d % 10);
+    buffer[10] = '\0';
+}
+
+/* =========================================================
+ *  日期时钟服务：“今天”每天只计算一次
+ *  目的：业务函数频繁需要当前日期，避免每次都执行 localtime + 格式化 + 再解析；
+ *       仅当系统时间越过下一个午夜时才刷新缓存
+ * ========================================================= */
+
+static long clock_today_days = 0;        /* 缓存的今日天数（0 表示尚未初始化） */
+static char clock_today_str[12];         /* 缓存的今日字符串 */
+static time_t clock_next_midnight = 0;   /* 缓存失效时刻：下一个本地午夜 */
+static int clock_fixed = 0;              /* 1=使用注入的固定日期 */
+
+/* clockRefresh：读取本地日期，更新缓存与下一个午夜时刻 */
+static void clockRefresh(time_t now) {
+    struct tm tm_info = *localtime(&now);
+    long y = tm_info.tm_year + 1900;
+    int m = tm_info.tm_mon + 1;
+    clock_today_days = yearStartDays(y) + cum_month_days[m] + ((m > 2) & isLeapYear((int)y)) + tm_info.tm_mday;
+    daysToDate(clock_today_days, clock_today_str);
+
+    tm_info.tm_mday += 1;
+    tm_info.tm_hour = tm_info.tm_min = tm_info.tm_sec = 0;
+    tm_info.tm_isdst = -1;
+    clock_next_midnight = mktime(&tm_info);
+}
+
+/* clockToday：返回今日天数；固定日期模式下直接返回注入值 */
+long clockToday() {
+    if (clock_fixed) return clock_today_days;
+    time_t now = time(NULL);
+    if (clock_today_days == 0 || now >= clock_next_midnight) clockRefresh(now);
+    return clock_today_days;
+}
+
+/* clockTodayStr：返回缓存的今日字符串（未初始化时先刷新） */
+const char* clockTodayStr() {
+    if (clock_today_days == 0) clockToday();
+    return clock_today_str;
+}
 
-    days += d;
-    return days;
+/* clockSetFixed：注入固定日期，便于测试与基准测试得到可重复结果；days<=0 时恢复系统时钟 */
+void clockSetFixed(long days) {
+    if (days <= 0) {
+        clock_fixed = 0;
+        clock_today_days = 0;
+        return;
+    }
+    clock_fixed = 1;
+    clock_today_days = days;
+    daysToDate(days, clock_today_str);
 }
 
-/* 会员类型对应的有效期天数 */
+/* 会员类型对应的名义有效期天数（用于类型校验与提示；实际到期日按自然月计算） */
 int getDurationDays(const char* type) {
     if (strcmp(type, "月卡") == 0) return 30;
     if (strcmp(type, "季卡") == 0) return 90;
@@ -199,76 +784,289 @@ int getDurationDays(const char* type) {
     return 0;
 }
 
+/* 会员类型对应的有效期月数 */
+int getDurationMonths(const char* type) {
+    if (strcmp(type, "月卡") == 0) return 1;
+    if (strcmp(type, "季卡") == 0) return 3;
+    if (strcmp(type, "年卡") == 0) return 12;
+    return 0;
+}
+
+/*
+ * addMonthsToDays：日期天数加上若干自然月
+ * 关键点：目标月天数不足时取该月最后一天（01-31 加 1 个月为 02-28/29）
+ */
+long addMonthsToDays(long days, int months) {
+    long y;
+    int m, d;
+    daysToYMD(days, &y, &m, &d);
+
+    long total = y * 12 + (m - 1) + months;
+    y = total / 12;
+    m = (int)(total % 12) + 1;
+    int dim = daysInMonth((int)y, m);
+    if (d > dim) d = dim;
+
+    return yearStartDays(y) + cum_month_days[m] + ((m > 2) & isLeapYear((int)y)) + d;
+}
+
 /* =========================================================
  *  UTF-8 中英文混排对齐输出
  *  目的：printf 宽度按字节计算，中文在 UTF-8 下会造成列错位；
  *       本程序按“视觉宽度”计算并手动补空格，实现表格对齐。
  * ========================================================= */
 
-/* utf8_decode：将一个 UTF-8 字符解码为 Unicode 码点，并返回占用字节数 */
+/*
+ * UTF-8 首字节查表：按首字节高 5 位给出序列长度（续字节/非法首字节按 1 字节处理）
+ * 0xxxx → 1，110xx → 2，1110x → 3，11110 → 4
+ */
+static const unsigned char utf8_lead_len[32] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 4, 1
+};
+
+/* utf8_decode：将一个 UTF-8 字符解码为 Unicode 码点，并返回占用字节数（序列长度查表） */
 static uint32_t utf8_decode(const char *s, int *bytes) {
-    unsigned char c = (unsigned char)s[0];
+    const unsigned char* p = (const unsigned char*)s;
+    unsigned char c = p[0];
+    int n = utf8_lead_len[c >> 3];
+
+    *bytes = n;
+    switch (n) {
+        case 2: return ((uint32_t)(c & 0x1F) << 6) | (uint32_t)(p[1] & 0x3F);
+        case 3: return ((uint32_t)(c & 0x0F) << 12) | ((uint32_t)(p[1] & 0x3F) << 6) |
+                       (uint32_t)(p[2] & 0x3F);
+        case 4: return ((uint32_t)(c & 0x07) << 18) | ((uint32_t)(p[1] & 0x3F) << 12) |
+                       ((uint32_t)(p[2] & 0x3F) << 6) | (uint32_t)(p[3] & 0x3F);
+        default: return c;
+    }
+}
 
-    if (c < 0x80) { *bytes = 1; return c; }
-    if ((c & 0xE0) == 0xC0) {
-        *bytes = 2;
-        return ((uint32_t)(c & 0x1F) << 6) | ((uint32_t)((unsigned char)s[1] & 0x3F));
+/*
+ * 显示宽度规则（区间表）：
+ *  - 宽字符（2 列）：CJK、谚文、全角符号等
+ *  - 零宽字符（0 列）：组合附加符号、零宽空格/连接符、方向控制符、变体选择符
+ * 零宽区间在宽字符区间之后生效（如 U+302A 组合声调位于 CJK 符号区内）
+ */
+typedef struct {
+    uint32_t lo;
+    uint32_t hi;
+} CodeRange;
+
+static const CodeRange wide_ranges[] = {
+    { 0x1100, 0x115F }, { 0x2E80, 0xA4CF }, { 0xAC00, 0xD7A3 }, { 0xF900, 0xFAFF },
+    { 0xFE10, 0xFE19 }, { 0xFE30, 0xFE6F }, { 0xFF00, 0xFF60 }, { 0xFFE0, 0xFFE6 }
+};
+
+static const CodeRange zero_ranges[] = {
+    { 0x0300, 0x036F }, { 0x0483, 0x0489 }, { 0x0591, 0x05BD }, { 0x0610, 0x061A },
+    { 0x064B, 0x065F }, { 0x0E31, 0x0E31 }, { 0x0E34, 0x0E3A }, { 0x0E47, 0x0E4E },
+    { 0x1AB0, 0x1AFF }, { 0x1DC0, 0x1DFF }, { 0x200B, 0x200F }, { 0x202A, 0x202E },
+    { 0x2060, 0x2064 }, { 0x20D0, 0x20FF }, { 0x302A, 0x302D }, { 0x3099, 0x309A },
+    { 0xFE00, 0xFE0F }, { 0xFE20, 0xFE2F }, { 0xFEFF, 0xFEFF }
+};
+
+/*
+ * BMP 两级宽度表：width_stage1[高 8 位] 给出块号，width_blocks[块号][低 8 位] 给出列宽
+ * 内容相同的 256 码点块共用一块（全窄、全宽各一块，其余为含区间边界的混合块），
+ * 首次使用时由区间表生成
+ */
+#define WIDTH_MAX_BLOCKS 32
+static unsigned char width_stage1[256];
+static unsigned char width_blocks[WIDTH_MAX_BLOCKS][256];
+static int width_table_ready = 0;
+
+/*
+ * byte_width：按字节直接给出列宽，续字节（10xxxxxx）计 0 列，字符列宽全部记在首字节上
+ * 首字节覆盖的码点区间列宽一致时（如 E4~E9 对应 U+4000~U+9FFF 全为宽字符），无需解码；
+ * 否则记为 WIDTH_BY_CODEPOINT，解码后查两级表
+ */
+#define WIDTH_BY_CODEPOINT 0xFF
+static unsigned char byte_width[256];
+
+/* fillWidthRanges：把区间表中落在 [base, base+255] 内的部分按 memset 写入一个块 */
+static void fillWidthRanges(unsigned char* block, uint32_t base, const CodeRange* ranges, size_t count,
+                            unsigned char w) {
+    for (size_t r = 0; r < count; r++) {
+        uint32_t lo = ranges[r].lo > base ? ranges[r].lo : base;
+        uint32_t hi = ranges[r].hi < base + 255 ? ranges[r].hi : base + 255;
+        if (lo <= hi) memset(block + (lo - base), w, hi - lo + 1);
     }
-    if ((c & 0xF0) == 0xE0) {
-        *bytes = 3;
-        return ((uint32_t)(c & 0x0F) << 12) |
-               ((uint32_t)((unsigned char)s[1] & 0x3F) << 6) |
-               ((uint32_t)((unsigned char)s[2] & 0x3F));
+}
+
+/*
+ * initWidthTable：由区间表生成两级宽度表（相同内容的块去重），再由两级表推出逐字节列宽表
+ * 说明：每块按区间裁剪后 memset 填充；逐字节列宽由块的“整块同宽”标记判定，不逐码点比较
+ */
+static void initWidthTable() {
+    unsigned char block[256];
+    unsigned char block_uniform[WIDTH_MAX_BLOCKS];   /* 整块列宽一致时为该列宽，否则 WIDTH_BY_CODEPOINT */
+    int used_blocks = 0;
+
+    for (int hi = 0; hi < 256; hi++) {
+        uint32_t base = (uint32_t)hi << 8;
+        memset(block, 1, sizeof(block));
+        fillWidthRanges(block, base, wide_ranges, sizeof(wide_ranges) / sizeof(wide_ranges[0]), 2);
+        fillWidthRanges(block, base, zero_ranges, sizeof(zero_ranges) / sizeof(zero_ranges[0]), 0);
+        if (hi == 0) block[0] = 0;
+
+        int id = 0;
+        while (id < used_blocks && memcmp(width_blocks[id], block, sizeof(block)) != 0) id++;
+        if (id == used_blocks) {
+            /* 区间表固定，块数远小于上限；此处仅为防御 */
+            if (used_blocks == WIDTH_MAX_BLOCKS) {
+                id = 0;
+            } else {
+                memcpy(width_blocks[used_blocks], block, sizeof(block));
+                block_uniform[used_blocks] = block[0];
+                for (int k = 1; k < 256; k++) {
+                    if (block[k] != block[0]) { block_uniform[used_blocks] = WIDTH_BY_CODEPOINT; break; }
+                }
+                used_blocks++;
+            }
+        }
+        width_stage1[hi] = (unsigned char)id;
     }
-    if ((c & 0xF8) == 0xF0) {
-        *bytes = 4;
-        return ((uint32_t)(c & 0x07) << 18) |
-               ((uint32_t)((unsigned char)s[1] & 0x3F) << 12) |
-               ((uint32_t)((unsigned char)s[2] & 0x3F) << 6) |
-               ((uint32_t)((unsigned char)s[3] & 0x3F));
+
+    for (int c = 0; c < 256; c++) {
+        if (c >= 0x80 && c < 0xC0) { byte_width[c] = 0; continue; }
+
+        int n = utf8_lead_len[c >> 3];
+        int w;
+        if (n == 1) {
+            w = width_blocks[width_stage1[0]][c];
+        } else if (n == 2) {
+            /* 2 字节首字节覆盖 64 个码点，位于同一块内 */
+            uint32_t lo = (uint32_t)(c & 0x1F) << 6;
+            const unsigned char* b = width_blocks[width_stage1[lo >> 8]] + (lo & 0xFF);
+            w = b[0];
+            for (int k = 1; k < 64 && w != WIDTH_BY_CODEPOINT; k++) {
+                if (b[k] != w) w = WIDTH_BY_CODEPOINT;
+            }
+        } else if (n == 3) {
+            /* 3 字节首字节覆盖 16 个整块：全部整块同宽且列宽相同才可免解码 */
+            int first = (c & 0x0F) << 4;
+            w = block_uniform[width_stage1[first]];
+            for (int k = 1; k < 16 && w != WIDTH_BY_CODEPOINT; k++) {
+                if (block_uniform[width_stage1[first + k]] != w) w = WIDTH_BY_CODEPOINT;
+            }
+        } else {
+            w = WIDTH_BY_CODEPOINT;
+        }
+        byte_width[c] = (unsigned char)w;
     }
-    *bytes = 1;
-    return c;
+    width_table_ready = 1;
 }
 
-/* 判断常见 CJK 宽字符范围：宽字符在控制台一般占 2 列 */
-static int is_cjk_wide(uint32_t u) {
-    return
-        (u >= 0x1100 && u <= 0x115F) ||
-        (u >= 0x2E80 && u <= 0xA4CF) ||
-        (u >= 0xAC00 && u <= 0xD7A3) ||
-        (u >= 0xF900 && u <= 0xFAFF) ||
-        (u >= 0xFE10 && u <= 0xFE19) ||
-        (u >= 0xFE30 && u <= 0xFE6F) ||
-        (u >= 0xFF00 && u <= 0xFF60) ||
-        (u >= 0xFFE0 && u <= 0xFFE6) ||
-        (u >= 0x20000 && u <= 0x3FFFD);
+/* char_width：码点的显示列宽（0/1/2）；调用前须已执行 initWidthTable */
+static int char_width(uint32_t u) {
+    if (u < 0x10000) return width_blocks[width_stage1[u >> 8]][u & 0xFF];
+    if (u >= 0xE0100 && u <= 0xE01EF) return 0;
+    if ((u >= 0x1F300 && u <= 0x1F64F) || (u >= 0x1F900 && u <= 0x1F9FF)) return 2;
+    if (u >= 0x20000 && u <= 0x3FFFD) return 2;
+    return 1;
 }
 
-static int char_width(uint32_t u) {
-    if (u == 0) return 0;
-    return is_cjk_wide(u) ? 2 : 1;
+/*
+ * asciiPrefixLen：s 开头纯 ASCII 字节数（最多 n），纯 ASCII 每字节恰占 1 列，无需解码
+ * 按 8 字节字检查最高位：姓名最多 29 字节，16 字节的 SIMD 寄存器至多用上一次，收益不抵分支开销
+ */
+static size_t asciiPrefixLen(const char* s, size_t n) {
+    size_t i = 0;
+    while (i + 8 <= n) {
+        uint64_t w;
+        memcpy(&w, s + i, sizeof(w));
+        if (w & 0x8080808080808080ULL) break;
+        i += 8;
+    }
+    while (i < n && !((unsigned char)s[i] & 0x80)) i++;
+    return i;
 }
 
 /*
- * printWithPad：按视觉宽度输出字符串，并补齐空格至 target_width
- * 关键处理：
- *  - 若字符串超过列宽，进行截断，避免挤占后续列导致错位
+ * measureText：计算字符串的视觉宽度，并给出按 limit 列截断时的字节数与截断后宽度
+ * 说明：
+ *  - 截断以整字符为单位，宽字符放不下时整体舍去（截断后宽度可能为 limit-1）
+ *  - 8 字节以上的纯 ASCII 字符串整段计宽（按 8 字节字检查最高位），不逐字处理；
+ *    更短的字符串直接走逐字节循环，避免多一次难以预测的分支
+ *  - 其余字符串逐字节查 byte_width 累加（续字节计 0 列，循环无跨字节依赖），
+ *    只有首字节无法确定列宽时才解码查两级表
  */
-void printWithPad(const char *str, int target_width) {
-    int used = 0;
-    for (int i = 0; str[i]; ) {
+static int measureText(const char* s, int limit, int* cut_bytes, int* cut_width) {
+    if (!width_table_ready) initWidthTable();
+
+    size_t n = strlen(s);
+    if (n >= 8 && asciiPrefixLen(s, n) == n) {
+        int w = (int)n;
+        *cut_bytes = w < limit ? w : limit;
+        *cut_width = *cut_bytes;
+        return w;
+    }
+
+    int used = 0, cut = -1, cut_used = 0;
+    for (size_t i = 0; i < n; i++) {
+        unsigned char c = (unsigned char)s[i];
+        int cw = byte_width[c];
+        if (cw == WIDTH_BY_CODEPOINT) {
+            int b = 0;
+            cw = i + utf8_lead_len[c >> 3] <= n ? char_width(utf8_decode(s + i, &b)) : 1;
+        }
+        if (cut < 0 && used + cw > limit) { cut = (int)i; cut_used = used; }
+        used += cw;
+    }
+    if (cut < 0) { cut = (int)n; cut_used = used; }
+    *cut_bytes = cut;
+    *cut_width = cut_used;
+    return used;
+}
+
+/*
+ * foldNameKey：生成姓名检索键（大小写与全角/半角归一）
+ * 规则：
+ *  - 全角 ASCII（U+FF01~U+FF5E）转为对应半角字符，全角空格 U+3000 转为空格
+ *  - 拉丁字母 A-Z 与 Latin-1 大写字母（U+00C0~U+00DE，除 ×）转为小写
+ *  - 其余字符（含中文）按原字节保留
+ * 说明：检索键在写入会员时计算一次，查询时只需对关键字折叠一次后做字节子串匹配
+ */
+static void foldNameKey(const char* src, char* dst, size_t dst_size) {
+    size_t o = 0;
+    for (int i = 0; src[i]; ) {
         int b = 0;
-        uint32_t u = utf8_decode(str + i, &b);
+        uint32_t u = utf8_decode(src + i, &b);
         if (b <= 0) b = 1;
 
-        int cw = char_width(u);
-        if (used + cw > target_width) break;
-
-        fwrite(str + i, 1, (size_t)b, stdout);
-        used += cw;
+        if (u >= 0xFF01 && u <= 0xFF5E) u -= 0xFEE0;
+        else if (u == 0x3000) u = ' ';
+
+        if (u >= 'A' && u <= 'Z') u += 32;
+        else if (u >= 0xC0 && u <= 0xDE && u != 0xD7) u += 32;
+
+        if (u < 0x80) {
+            if (o + 1 >= dst_size) break;
+            dst[o++] = (char)u;
+        } else if (u < 0x100 && b == 2) {
+            if (o + 2 >= dst_size) break;
+            dst[o++] = (char)(0xC0 | (u >> 6));
+            dst[o++] = (char)(0x80 | (u & 0x3F));
+        } else {
+            if (o + (size_t)b >= dst_size) break;
+            memcpy(dst + o, src + i, (size_t)b);
+            o += (size_t)b;
+        }
         i += b;
     }
+    dst[o] = '\0';
+}
+
+/*
+ * printWithPad：按视觉宽度输出字符串，并补齐空格至 target_width
+ * 关键处理：
+ *  - 若字符串超过列宽，进行截断，避免挤占后续列导致错位
+ */
+void printWithPad(const char *str, int target_width) {
+    int cut = 0, used = 0;
+    measureText(str, target_width, &cut, &used);
+    fwrite(str, 1, (size_t)cut, stdout);
     for (int k = used; k < target_width; k++) putchar(' ');
 }
 
@@ -280,85 +1078,825 @@ void printSeparator() {
     putchar('\n');
 }
 
+/* =========================================================
+ *  定长格式化与缓冲输出
+ *  目的：列表/保存/导出的数字与日期字段格式固定，手写转换直接写入缓冲区，
+ *       避免 printf 族函数逐字段解析格式串
+ * ========================================================= */
+
+/* fmtLong：十进制整数写入 dst（不含结束符），返回写入末尾位置 */
+static char* fmtLong(char* dst, long v) {
+    char tmp[24];
+    int n = 0;
+    unsigned long u = v < 0 ? 0UL - (unsigned long)v : (unsigned long)v;
+    do { tmp[n++] = (char)('0' + u % 10); u /= 10; } while (u);
+    if (v < 0) *dst++ = '-';
+    while (n) *dst++ = tmp[--n];
+    return dst;
+}
+
+/* obInit：绑定输出文件并清空缓冲 */
+static void obInit(OutBuf* ob, FILE* fp) {
+    ob->fp = fp;
+    ob->len = 0;
+    ob->error = 0;
+}
+
+/* obFlush：写出缓冲内容；返回 1 表示迄今所有写入均成功 */
+static int obFlush(OutBuf* ob) {
+    if (ob->len > 0 && fwrite(ob->data, 1, ob->len, ob->fp) != ob->len) ob->error = 1;
+    ob->len = 0;
+    return !ob->error;
+}
+
+/* obWrite：追加 n 字节；超过缓冲区剩余空间时先写出 */
+static void obWrite(OutBuf* ob, const char* s, size_t n) {
+    if (ob->len + n > sizeof(ob->data)) {
+        obFlush(ob);
+        if (n > sizeof(ob->data)) {
+            if (fwrite(s, 1, n, ob->fp) != n) ob->error = 1;
+            return;
+        }
+    }
+    memcpy(ob->data + ob->len, s, n);
+    ob->len += n;
+}
+
+static void obPutc(OutBuf* ob, char c) {
+    if (ob->len == sizeof(ob->data)) obFlush(ob);
+    ob->data[ob->len++] = c;
+}
+
+static void obPuts(OutBuf* ob, const char* s) {
+    obWrite(ob, s, strlen(s));
+}
+
+/* obLong：整数直接格式化到缓冲区（预留 24 字节，避免中间拷贝） */
+static void obLong(OutBuf* ob, long v) {
+    if (ob->len + 24 > sizeof(ob->data)) obFlush(ob);
+    ob->len = (size_t)(fmtLong(ob->data + ob->len, v) - ob->data);
+}
+
+/* obPad：追加 n 个空格（整段 memset） */
+static void obPad(OutBuf* ob, int n) {
+    if (n <= 0) return;
+    if (ob->len + (size_t)n > sizeof(ob->data)) obFlush(ob);
+    memset(ob->data + ob->len, ' ', (size_t)n);
+    ob->len += (size_t)n;
+}
+
+/* obAsciiPad：写入纯 ASCII 字段并补空格（ASCII 字节数即视觉宽度，无需逐字解码） */
+static void obAsciiPad(OutBuf* ob, const char* s, size_t len, int target_width) {
+    obWrite(ob, s, len);
+    obPad(ob, target_width - (int)len);
+}
+
+/*
+ * obTextPad：按视觉宽度写入字段并补齐空格（截断规则与 printWithPad 相同）
+ * 关键点：先确定可容纳的字节数与宽度，再整段 memcpy 字段字节、memset 补齐
+ */
+static void obTextPad(OutBuf* ob, const char* s, int target_width) {
+    int cut = 0, used = 0;
+    measureText(s, target_width, &cut, &used);
+    obWrite(ob, s, (size_t)cut);
+    obPad(ob, target_width - used);
+}
+
+/* obNameCell：姓名列直接复制预计算的截断字节并补齐，不再解码 */
+static void obNameCell(OutBuf* ob, const Node* p) {
+    obWrite(ob, p->data.name, p->name_cut);
+    obPad(ob, W_NAME - p->name_cut_width);
+}
+
+/* obSeparator：写入与表格列宽一致的分隔线 */
+static void obSeparator(OutBuf* ob) {
+    int total = W_CARD + 1 + W_NAME + 1 + W_GENDER + 1 + W_AGE + 1 + W_PHONE + 1
+              + W_DATE + 1 + W_TYPE + 1 + W_STATUS + 1 + W_LEFT;
+    if (ob->len + (size_t)total + 1 > sizeof(ob->data)) obFlush(ob);
+    memset(ob->data + ob->len, '-', (size_t)total);
+    ob->len += (size_t)total;
+    ob->data[ob->len++] = '\n';
+}
+
 /* =========================================================
  *  链表管理：创建、追加、查找、释放
  * ========================================================= */
 
-/* createNode：为一个会员记录分配链表结点并初始化 bonus_days=0 */
+/* createNode：为一个会员记录分配链表结点，初始化 renew_periods/bonus_days=0 并预计算到期日、姓名检索键与显示宽度 */
 Node* createNode(const Member* m) {
     Node* node = (Node*)malloc(sizeof(Node));
     if (!node) return NULL;
     node->data = *m;
+    node->renew_periods = 0;
     node->bonus_days = 0;
+    node->bucket_prev = node->bucket_next = NULL;
+    node->bucket_slot = -1;
+    node->bucket_type = -1;
+    node->bucket_far = 0;
+    node->dash_type = -1;
+    node->dash_window = 0;
+    updateExpireDay(node);
+    foldNameKey(node->data.name, node->name_key, sizeof(node->name_key));
+    int cut = 0, cut_width = 0;
+    measureText(node->data.name, W_NAME, &cut, &cut_width);
+    node->name_cut = (unsigned char)cut;
+    node->name_cut_width = (unsigned char)cut_width;
+    node->row_cache = NULL;
+    node->row_len = 0;
+    node->row_day = -1;
     node->next = NULL;
     return node;
 }
 
-/* appendNode：尾插法追加结点；维护 tail 指针并更新 member_count */
-void appendNode(Node* node) {
-    if (!node) return;
-    if (!head) head = tail = node;
-    else { tail->next = node; tail = node; }
-    member_count++;
+/*
+ * cardIndexLowerBound：二分查找第一个 card_id >= id 的索引位置
+ * 返回值范围 0..member_count（等于 member_count 表示 id 大于全部卡号）
+ */
+static int cardIndexLowerBound(int id) {
+    int lo = 0, hi = member_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (card_index[mid]->data.card_id < id) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
 }
 
-/* findByCardID：按卡号在链表中查找会员结点；未找到返回 NULL */
-Node* findByCardID(int id) {
-    for (Node* p = head; p; p = p->next) {
-        if (p->data.card_id == id) return p;
-    }
-    return NULL;
+/* expireColumnValue：到期日列取值；已注销会员取 INT32_MIN，批量判定时恒为无效 */
+static int32_t expireColumnValue(const Node* p) {
+    return p->data.is_active == 1 ? (int32_t)p->expire_day : INT32_MIN;
 }
 
-/* freeAllMembers：释放链表所有结点并清空全局状态 */
-void freeAllMembers() {
-    Node* p = head;
-    while (p) {
-        Node* nxt = p->next;
-        free(p);
-        p = nxt;
+/*
+ * cardIndexInsert：将结点按卡号有序插入索引与到期日列（不修改 member_count）
+ * 关键点：
+ *  - 容量不足时倍增扩容（两个数组同步扩容）
+ *  - 卡号大于末尾元素时直接追加，避免二分与搬移
+ */
+static int cardIndexInsert(Node* node) {
+    if (member_count >= card_index_cap) {
+        int new_cap = card_index_cap ? card_index_cap * 2 : 64;
+        Node** grown = (Node**)realloc(card_index, (size_t)new_cap * sizeof(Node*));
+        if (!grown) return 0;
+        card_index = grown;
+        int32_t* grown_col = (int32_t*)realloc(expire_col, (size_t)new_cap * sizeof(int32_t));
+        if (!grown_col) return 0;
+        expire_col = grown_col;
+        card_index_cap = new_cap;
     }
-    head = tail = NULL;
-    member_count = 0;
+
+    int pos = member_count;
+    if (member_count > 0 && card_index[member_count - 1]->data.card_id > node->data.card_id) {
+        pos = cardIndexLowerBound(node->data.card_id);
+        memmove(card_index + pos + 1, card_index + pos,
+                (size_t)(member_count - pos) * sizeof(Node*));
+        memmove(expire_col + pos + 1, expire_col + pos,
+                (size_t)(member_count - pos) * sizeof(int32_t));
+    }
+    card_index[pos] = node;
+    expire_col[pos] = expireColumnValue(node);
+    return 1;
 }
 
-/* calcExpireDays：计算会员到期日（入会日 + 套餐天数 + bonus_days） */
-static long calcExpireDays(Node* p) {
-    long join_days = dateToDays(p->data.join_date);
-    int duration = getDurationDays(p->data.membership_type);
-    return join_days + duration + p->bonus_days;
+/* cardIndexRemove：从索引与到期日列中移除指定卡号（调用方负责 member_count 递减） */
+static void cardIndexRemove(int id) {
+    int pos = cardIndexLowerBound(id);
+    if (pos >= member_count || card_index[pos]->data.card_id != id) return;
+    memmove(card_index + pos, card_index + pos + 1,
+            (size_t)(member_count - pos - 1) * sizeof(Node*));
+    memmove(expire_col + pos, expire_col + pos + 1,
+            (size_t)(member_count - pos - 1) * sizeof(int32_t));
 }
 
 /* =========================================================
- *  自动到期同步：确保状态与系统日期一致
+ *  排序排列：按姓名/到期日/入会日期/类型+到期日列表
+ *  各排列只比较结点上记录的排序键（sort_*），键值同步由 sortPermReposition 负责
  * ========================================================= */
 
-/*
- * syncAutoExpire：
- *  - 对 is_active==1 的会员计算剩余天数
- *  - 若剩余天数 < 0，则自动标记为过期（is_active=0）
- * 设计意义：避免依赖人工维护状态，保证列表/统计/查询的时效性
- */
-void syncAutoExpire() {
-    if (!head) return;
+/* sortKeyCompare：按 order 比较两个结点的排序键，卡号作为最终决胜键，保证全序 */
+static int sortKeyCompare(ListOrder order, const Node* a, const Node* b) {
+    int c = 0;
+    switch (order) {
+        case LIST_BY_NAME:
+            c = strcmp(a->name_key, b->name_key);
+            break;
+        case LIST_BY_TYPE_EXPIRY:
+            c = (a->sort_type > b->sort_type) - (a->sort_type < b->sort_type);
+            if (c == 0) c = (a->sort_expire > b->sort_expire) - (a->sort_expire < b->sort_expire);
+            break;
+        case LIST_BY_EXPIRY:
+            c = (a->sort_expire > b->sort_expire) - (a->sort_expire < b->sort_expire);
+            break;
+        case LIST_BY_JOINED:
+            c = (a->sort_joined > b->sort_joined) - (a->sort_joined < b->sort_joined);
+            break;
+        default:
+            break;
+    }
+    if (c != 0) return c;
+    return (a->data.card_id > b->data.card_id) - (a->data.card_id < b->data.card_id);
+}
 
-    char current_date_str[12];
-    getSystemDate(current_date_str);
-    long current_days = dateToDays(current_date_str);
+/* sortKeysSnapshot：把结点当前的到期日/入会日期/类型记为排序键 */
+static void sortKeysSnapshot(Node* p) {
+    p->sort_expire = p->expire_day;
+    p->sort_joined = p->join_day;
+    p->sort_type = (signed char)memberTypeIndex(p->data.membership_type);
+}
 
-    for (Node* p = head; p; p = p->next) {
-        if (p->data.is_active == 1) {
-            long expire_days = calcExpireDays(p);
-            if (expire_days - current_days < 0) {
-                p->data.is_active = 0;
-            }
-        }
+/* sortPermLowerBound：在 [lo, hi) 内找第一个排序键不小于 p 的位置 */
+static int sortPermLowerBound(ListOrder order, int lo, int hi, const Node* p) {
+    Node** perm = sort_perm[order];
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (sortKeyCompare(order, perm[mid], p) < 0) lo = mid + 1;
+        else hi = mid;
     }
+    return lo;
 }
 
-/* =========================================================
- *  文件持久化：读取与写回 members.txt
- * ========================================================= */
+/* sortPermDrop：丢弃一份排列（维护失败时使用，下次列表时重建） */
+static void sortPermDrop(ListOrder order) {
+    free(sort_perm[order]);
+    sort_perm[order] = NULL;
+    sort_perm_cap[order] = 0;
+}
+
+/* qsort 比较回调：qsort 无上下文参数，建立排列期间由 sort_build_order 指定排序方式 */
+static ListOrder sort_build_order;
+static int sortPermQsortCmp(const void* a, const void* b) {
+    return sortKeyCompare(sort_build_order, *(Node* const*)a, *(Node* const*)b);
+}
+
+/* sortPermGet：取得按 order 排好序的排列（长度 member_count）；首次使用时建立，内存不足返回 NULL */
+static Node** sortPermGet(ListOrder order) {
+    if (order <= LIST_INSERTION || order >= LIST_ORDERS) return NULL;
+    if (sort_perm[order]) return sort_perm[order];
+
+    int cap = member_count > 64 ? member_count : 64;
+    Node** perm = (Node**)malloc((size_t)cap * sizeof(Node*));
+    if (!perm) return NULL;
+    memcpy(perm, card_index, (size_t)member_count * sizeof(Node*));
+
+    sort_build_order = order;
+    qsort(perm, (size_t)member_count, sizeof(Node*), sortPermQsortCmp);
+    sort_perm[order] = perm;
+    sort_perm_cap[order] = cap;
+    return perm;
+}
+
+/* sortPermInsertOne：在长度为 n 的已建立排列中插入结点 */
+static void sortPermInsertOne(ListOrder order, Node* p, int n) {
+    if (n >= sort_perm_cap[order]) {
+        int new_cap = sort_perm_cap[order] * 2;
+        Node** grown = (Node**)realloc(sort_perm[order], (size_t)new_cap * sizeof(Node*));
+        if (!grown) { sortPermDrop(order); return; }
+        sort_perm[order] = grown;
+        sort_perm_cap[order] = new_cap;
+    }
+    Node** perm = sort_perm[order];
+    int pos = sortPermLowerBound(order, 0, n, p);
+    memmove(perm + pos + 1, perm + pos, (size_t)(n - pos) * sizeof(Node*));
+    perm[pos] = p;
+}
+
+/* sortPermRemoveOne：在长度为 n 的已建立排列中按结点当前排序键定位并摘除 */
+static void sortPermRemoveOne(ListOrder order, Node* p, int n) {
+    Node** perm = sort_perm[order];
+    int pos = sortPermLowerBound(order, 0, n, p);
+    if (pos >= n || perm[pos] != p) { sortPermDrop(order); return; }
+    memmove(perm + pos, perm + pos + 1, (size_t)(n - pos - 1) * sizeof(Node*));
+}
+
+/* sortPermInsert：新结点入库时记录排序键并插入各已建立排列（在 member_count 递增前调用） */
+static void sortPermInsert(Node* p) {
+    sortKeysSnapshot(p);
+    for (int o = LIST_INSERTION + 1; o < LIST_ORDERS; o++) {
+        if (sort_perm[o]) sortPermInsertOne((ListOrder)o, p, member_count);
+    }
+}
+
+/* sortPermRemove：结点删除时从各已建立排列中摘除（在 member_count 递减前调用） */
+static void sortPermRemove(Node* p) {
+    for (int o = LIST_INSERTION + 1; o < LIST_ORDERS; o++) {
+        if (sort_perm[o]) sortPermRemoveOne((ListOrder)o, p, member_count);
+    }
+}
+
+/*
+ * sortPermMove：结点键值已更新，把它从 old 位置移到新位置（排列长度为 n）
+ * 关键点：新位置只可能在旧位置一侧，只搬移两者之间的一段（续费顺延等小幅变化时搬移量很小）
+ */
+static void sortPermMove(ListOrder order, Node* p, int old, int n) {
+    Node** perm = sort_perm[order];
+    if (old + 1 < n && sortKeyCompare(order, perm[old + 1], p) < 0) {
+        int pos = sortPermLowerBound(order, old + 1, n, p);
+        memmove(perm + old, perm + old + 1, (size_t)(pos - old - 1) * sizeof(Node*));
+        perm[pos - 1] = p;
+    } else if (old > 0 && sortKeyCompare(order, perm[old - 1], p) > 0) {
+        int pos = sortPermLowerBound(order, 0, old, p);
+        memmove(perm + pos + 1, perm + pos, (size_t)(old - pos) * sizeof(Node*));
+        perm[pos] = p;
+    }
+}
+
+/*
+ * sortPermReposition：结点到期日/入会日期/类型变化后，调整其在各排列中的位置
+ * 关键点：只处理键值确实变化的排列；先按旧键定位，再更新键值后就地移动（姓名不可修改，姓名排列不受影响）
+ */
+static void sortPermReposition(Node* p) {
+    long joined = p->join_day;
+    signed char type = (signed char)memberTypeIndex(p->data.membership_type);
+    int expire_changed = p->sort_expire != p->expire_day;
+    int changed[LIST_ORDERS] = {0};
+    changed[LIST_BY_EXPIRY] = expire_changed;
+    changed[LIST_BY_JOINED] = p->sort_joined != joined;
+    changed[LIST_BY_TYPE_EXPIRY] = expire_changed || p->sort_type != type;
+
+    int old_pos[LIST_ORDERS];
+    for (int o = LIST_INSERTION + 1; o < LIST_ORDERS; o++) {
+        old_pos[o] = -1;
+        if (!sort_perm[o] || !changed[o]) continue;
+        int pos = sortPermLowerBound((ListOrder)o, 0, member_count, p);
+        if (pos < member_count && sort_perm[o][pos] == p) old_pos[o] = pos;
+        else sortPermDrop((ListOrder)o);
+    }
+    sortKeysSnapshot(p);
+    for (int o = LIST_INSERTION + 1; o < LIST_ORDERS; o++) {
+        if (old_pos[o] >= 0) sortPermMove((ListOrder)o, p, old_pos[o], member_count);
+    }
+}
+
+/* sortPermFreeAll：释放全部排列 */
+static void sortPermFreeAll() {
+    for (int o = 0; o < LIST_ORDERS; o++) sortPermDrop((ListOrder)o);
+}
+
+/* invalidateRowCache：会员信息变化后使缓存的表格行失效（下次显示时重新排版） */
+static void invalidateRowCache(Node* p) {
+    p->row_day = -1;
+}
+
+/* refreshExpiryIndexes：到期日或注销状态变化后同步到期日列、到期日桶、行缓存并发出变更通知（结点尚未入库时忽略索引） */
+static void refreshExpiryIndexes(Node* p) {
+    invalidateRowCache(p);
+    int pos = cardIndexLowerBound(p->data.card_id);
+    if (pos < member_count && card_index[pos] == p) {
+        expire_col[pos] = expireColumnValue(p);
+        bucketLink(p);
+        sortPermReposition(p);
+        emitChange(CHANGE_UPDATED, p);
+    }
+}
+
+/* appendNode：尾插法追加结点；维护 tail 指针、卡号索引、排序排列、布隆过滤器、到期日桶并更新 member_count，最后发出变更通知；索引扩容失败返回 0 */
+int appendNode(Node* node) {
+    if (!node) return 0;
+    if (!cardIndexInsert(node)) return 0;
+    sortPermInsert(node);
+    bloomAdd(node->data.card_id);
+    bucketLink(node);
+    if (!head) head = tail = node;
+    else { tail->next = node; tail = node; }
+    member_count++;
+    emitChange(CHANGE_ADDED, node);
+    return 1;
+}
+
+/* findByCardID：按卡号在有序索引中二分查找会员结点；未找到返回 NULL */
+Node* findByCardID(int id) {
+    int pos = cardIndexLowerBound(id);
+    if (pos < member_count && card_index[pos]->data.card_id == id) return card_index[pos];
+    return NULL;
+}
+
+/* freeNode：释放结点及其行缓存（与 free 一样接受 NULL） */
+static void freeNode(Node* p) {
+    if (!p) return;
+    free(p->row_cache);
+    free(p);
+}
+
+/* freeAllMembers：释放链表所有结点并清空全局状态 */
+void freeAllMembers() {
+    Node* p = head;
+    while (p) {
+        Node* nxt = p->next;
+        freeNode(p);
+        p = nxt;
+    }
+    head = tail = NULL;
+    member_count = 0;
+
+    free(card_index);
+    free(expire_col);
+    sortPermFreeAll();
+    card_index = NULL;
+    expire_col = NULL;
+    card_index_cap = 0;
+
+    memset(expiry_buckets, 0, sizeof(expiry_buckets));
+    memset(ring_counts, 0, sizeof(ring_counts));
+    memset(ring_far_counts, 0, sizeof(ring_far_counts));
+    ring_base_day = 0;
+    emitChange(CHANGE_CLEARED, NULL);
+}
+
+/*
+ * updateExpireDay：重新计算并缓存到期日（入会日 + 套餐月数 ×（1 + renew_periods）+ bonus_days）
+ * 说明：自然月换算只在写入时（新增/续费/加载）执行一次，读取路径直接比较 expire_day；
+ *       总月数一次性从入会日加上，月末截断不会在多次续费间累积
+ */
+static void updateExpireDay(Node* p) {
+    p->join_day = dateToDays(p->data.join_date);
+    int months = getDurationMonths(p->data.membership_type) * (1 + p->renew_periods);
+    p->expire_day = addMonthsToDays(p->join_day, months) + p->bonus_days;
+    refreshExpiryIndexes(p);
+}
+
+/* calcExpireDays：返回缓存的到期日 */
+static long calcExpireDays(const Node* p) {
+    return p->expire_day;
+}
+
+/* =========================================================
+ *  会员状态判定：存储状态与派生状态分离
+ * ========================================================= */
+
+/*
+ * isMemberActive：
+ *  - 存储状态 is_active 只表示“是否被手动注销”
+ *  - 是否到期由缓存的 expire_day 与今天比较得出，读取时计算、不回写结点
+ * 设计意义：查询/列表/统计均为只读操作，不会触发全量写入，也不会因读取而产生保存差异
+ */
+static int isMemberActive(const Node* p, long today) {
+    return p->data.is_active == 1 && p->expire_day >= today;
+}
+
+/* =========================================================
+ *  批量到期判定：对到期日列做向量化比较
+ *  目的：夜间报表/导入等批处理需要对全体会员判定有效状态；
+ *       按列比较 expire >= today 生成有效位图，并在同一遍中用 popcount 统计总数
+ * ========================================================= */
+
+/* popcount64：统计 64 位字中置位个数 */
+static int popcount64(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/* ctz64：最低置位的位置（x 非 0），用于遍历有效位图 */
+static int ctz64(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (!(x & 1)) { x >>= 1; n++; }
+    return n;
+#endif
+}
+
+/* bulkEvalActiveScalar：标量版本（SIMD 不可用时的回退，也用于尾部与基准对照） */
+static long bulkEvalActiveScalar(const int32_t* expire, size_t n, int32_t today, uint64_t* bitmap) {
+    long total = 0;
+    for (size_t w = 0; w * 64 < n; w++) {
+        uint64_t bits = 0;
+        size_t end = (w + 1) * 64 < n ? (w + 1) * 64 : n;
+        for (size_t i = w * 64; i < end; i++) {
+            bits |= (uint64_t)(expire[i] >= today) << (i - w * 64);
+        }
+        bitmap[w] = bits;
+        total += popcount64(bits);
+    }
+    return total;
+}
+
+/*
+ * bulkEvalActive：expire[i] >= today 时置位 bitmap 第 i 位，返回有效总数
+ * 关键点：
+ *  - bitmap 需容纳 (n + 63) / 64 个 64 位字
+ *  - AVX2 每次比较 8 个、SSE2 每次比较 4 个，比较掩码经 movemask 拼成 64 位字后立即 popcount
+ *  - 不足 64 个的尾部交给标量版本
+ */
+long bulkEvalActive(const int32_t* expire, size_t n, int32_t today, uint64_t* bitmap) {
+    size_t full = n / 64;
+    long total = 0;
+
+#if defined(__AVX2__)
+    __m256i limit = _mm256_set1_epi32(today - 1);
+    for (size_t w = 0; w < full; w++) {
+        const int32_t* base = expire + w * 64;
+        uint64_t bits = 0;
+        for (int k = 0; k < 8; k++) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(base + k * 8));
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, limit)));
+            bits |= (uint64_t)(unsigned)mask << (k * 8);
+        }
+        bitmap[w] = bits;
+        total += popcount64(bits);
+    }
+#elif defined(__SSE2__)
+    __m128i limit = _mm_set1_epi32(today - 1);
+    for (size_t w = 0; w < full; w++) {
+        const int32_t* base = expire + w * 64;
+        uint64_t bits = 0;
+        for (int k = 0; k < 16; k++) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(base + k * 4));
+            int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, limit)));
+            bits |= (uint64_t)(unsigned)mask << (k * 4);
+        }
+        bitmap[w] = bits;
+        total += popcount64(bits);
+    }
+#else
+    full = 0;
+#endif
+
+    if (full * 64 < n) {
+        total += bulkEvalActiveScalar(expire + full * 64, n - full * 64, today, bitmap + full);
+    }
+    return total;
+}
+
+/* =========================================================
+ *  到期日桶环：按到期日分桶的 366 日环
+ *  目的：续费提醒、到期调度与剩余天数分布只访问日桶，不再扫描全体会员
+ *  说明：
+ *   - 仅未注销且到期日不早于基准日的会员挂入桶；到期日超过一年的会员按取模落入同一槽位，
+ *     访问时以 expire_day 精确比对过滤，并计入 ring_far_counts
+ *   - 新增/续费/注销时更新；跨日后由调度器调用 ringAdvance 摘除到期会员、
+ *     并把进入一年窗口的会员从“窗口外”计数移入日计数
+ * ========================================================= */
+
+/* memberTypeIndex：会员类型 -> 计数下标（0=月卡 1=季卡 2=年卡，未知类型返回 -1） */
+static int memberTypeIndex(const char* type) {
+    if (strcmp(type, "月卡") == 0) return 0;
+    if (strcmp(type, "季卡") == 0) return 1;
+    if (strcmp(type, "年卡") == 0) return 2;
+    return -1;
+}
+
+/* bucketUnlink：将会员从所在日桶摘除并回退计数（未挂入时无操作） */
+static void bucketUnlink(Node* p) {
+    if (p->bucket_slot < 0) return;
+    if (p->bucket_prev) p->bucket_prev->bucket_next = p->bucket_next;
+    else expiry_buckets[p->bucket_slot] = p->bucket_next;
+    if (p->bucket_next) p->bucket_next->bucket_prev = p->bucket_prev;
+
+    if (p->bucket_type >= 0) {
+        if (p->bucket_far) ring_far_counts[p->bucket_type]--;
+        else ring_counts[p->bucket_slot][p->bucket_type]--;
+    }
+
+    p->bucket_prev = p->bucket_next = NULL;
+    p->bucket_slot = -1;
+    p->bucket_type = -1;
+}
+
+/* bucketLink：按当前到期日（重新）挂入日桶并计数；已注销或早于基准日到期的会员只摘除不挂入 */
+static void bucketLink(Node* p) {
+    bucketUnlink(p);
+    if (ring_base_day == 0) ring_base_day = clockToday();
+    if (p->data.is_active != 1 || p->expire_day < ring_base_day) return;
+
+    int slot = (int)(p->expire_day % EXPIRY_RING_DAYS);
+    p->bucket_slot = slot;
+    p->bucket_prev = NULL;
+    p->bucket_next = expiry_buckets[slot];
+    if (p->bucket_next) p->bucket_next->bucket_prev = p;
+    expiry_buckets[slot] = p;
+
+    p->bucket_type = (signed char)memberTypeIndex(p->data.membership_type);
+    p->bucket_far = (signed char)(p->expire_day - ring_base_day >= EXPIRY_RING_DAYS);
+    if (p->bucket_type >= 0) {
+        if (p->bucket_far) ring_far_counts[p->bucket_type]++;
+        else ring_counts[slot][p->bucket_type]++;
+    }
+}
+
+/* ringRebuild：以 base 为基准日清空并重新挂入全部会员（长时间未推进或日期回拨时使用） */
+static void ringRebuild(long base) {
+    memset(expiry_buckets, 0, sizeof(expiry_buckets));
+    memset(ring_counts, 0, sizeof(ring_counts));
+    memset(ring_far_counts, 0, sizeof(ring_far_counts));
+    ring_base_day = base;
+    for (Node* p = head; p; p = p->next) {
+        p->bucket_prev = p->bucket_next = NULL;
+        p->bucket_slot = -1;
+        p->bucket_type = -1;
+        bucketLink(p);
+    }
+}
+
+/*
+ * ringAdvance：将桶环基准日逐日推进到 new_base
+ * 每推进一天 d（基准日 d -> d+1）：
+ *  - 槽位 d 中 expire_day==d 的会员已到期：回调 on_expire 后摘除
+ *  - 同一槽位中 expire_day==d+366 的会员刚进入一年窗口：从窗口外计数移入日计数
+ */
+static void ringAdvance(long new_base, void (*on_expire)(const Node* p)) {
+    if (ring_base_day == 0 || new_base < ring_base_day) { ringRebuild(new_base); return; }
+
+    for (long d = ring_base_day; d < new_base; d++) {
+        int slot = (int)(d % EXPIRY_RING_DAYS);
+        Node* p = expiry_buckets[slot];
+        while (p) {
+            Node* nxt = p->bucket_next;
+            if (p->expire_day == d) {
+                if (on_expire) on_expire(p);
+                bucketUnlink(p);
+            } else if (p->expire_day == d + EXPIRY_RING_DAYS && p->bucket_far) {
+                p->bucket_far = 0;
+                if (p->bucket_type >= 0) {
+                    ring_far_counts[p->bucket_type]--;
+                    ring_counts[slot][p->bucket_type]++;
+                }
+            }
+            p = nxt;
+        }
+        ring_base_day = d + 1;
+    }
+}
+
+/*
+ * forEachExpiring：按剩余天数升序访问 window 天内（含今天）到期的有效会员
+ * 关键点：只访问 window+1 个日桶，成本与窗口内会员数相关，与会员总数无关
+ * 返回值：访问的会员数量
+ */
+int forEachExpiring(long today, int window, void (*visit)(Node* p, long days_left, void* ctx), void* ctx) {
+    if (window < 0) return 0;
+    if (window >= EXPIRY_RING_DAYS) window = EXPIRY_RING_DAYS - 1;
+
+    int visited = 0;
+    for (long d = today; d <= today + window; d++) {
+        for (Node* p = expiry_buckets[d % EXPIRY_RING_DAYS]; p; p = p->bucket_next) {
+            if (p->expire_day != d || p->data.is_active != 1) continue;
+            if (visit) visit(p, d - today, ctx);
+            visited++;
+        }
+    }
+    return visited;
+}
+
+/* histAdd：将 count 个剩余 days_left 天、类型为 t 的会员计入分布 */
+static void histAdd(ExpiryHistogram* h, long days_left, int t, int count) {
+    if (days_left >= EXPIRY_RING_DAYS) { h->beyond[t] += count; return; }
+    h->week[days_left / 7][t] += count;
+    h->month[days_left / 30][t] += count;
+}
+
+/*
+ * buildHistogramIncremental：由日桶计数生成剩余天数分布
+ * 关键点：只读取 366 个槽位的计数，耗时与会员总数无关；调用前桶环基准日需已推进到 today
+ */
+void buildHistogramIncremental(long today, ExpiryHistogram* h) {
+    memset(h, 0, sizeof(*h));
+    for (long k = 0; k < EXPIRY_RING_DAYS; k++) {
+        const int* c = ring_counts[(today + k) % EXPIRY_RING_DAYS];
+        for (int t = 0; t < MEMBER_TYPES; t++) if (c[t]) histAdd(h, k, t, c[t]);
+    }
+    for (int t = 0; t < MEMBER_TYPES; t++) h->beyond[t] += ring_far_counts[t];
+}
+
+/* buildHistogramScan：全量扫描一遍生成剩余天数分布（与增量结果对照） */
+void buildHistogramScan(long today, ExpiryHistogram* h) {
+    memset(h, 0, sizeof(*h));
+    for (Node* p = head; p; p = p->next) {
+        if (!isMemberActive(p, today)) continue;
+        int t = memberTypeIndex(p->data.membership_type);
+        if (t >= 0) histAdd(h, p->expire_day - today, t, 1);
+    }
+}
+
+/* =========================================================
+ *  到期调度器：按天触发到期事件
+ *  说明：程序为单线程交互结构，调度器由菜单循环在每次交互前调用 schedulerTick；
+ *       “今天”由时钟服务缓存，未跨日时 tick 仅为一次整数比较，跨过午夜后才处理到期
+ * ========================================================= */
+
+/* 到期事件订阅者 */
+static struct {
+    ExpiryListener fn;
+    void* ctx;
+} expiry_listeners[MAX_EXPIRY_LISTENERS];
+static int expiry_listener_count = 0;
+
+/* 调度器已处理到的日期（0 表示尚未启动） */
+static long scheduler_last_day = 0;
+
+/* expirySubscribe：注册到期事件回调；订阅者已满返回 0 */
+int expirySubscribe(ExpiryListener fn, void* ctx) {
+    if (expiry_listener_count >= MAX_EXPIRY_LISTENERS) return 0;
+    expiry_listeners[expiry_listener_count].fn = fn;
+    expiry_listeners[expiry_listener_count].ctx = ctx;
+    expiry_listener_count++;
+    return 1;
+}
+
+/* emitExpiry：向全部订阅者分发一条到期事件（已注销会员不发出） */
+static void emitExpiry(const Node* p) {
+    if (p->data.is_active != 1) return;
+    for (int i = 0; i < expiry_listener_count; i++) {
+        expiry_listeners[i].fn(p, p->expire_day, expiry_listeners[i].ctx);
+    }
+}
+
+/*
+ * runExpiryForDays：处理 [from_day, to_day) 区间内到期的会员
+ * 关键点：
+ *  - expire_day 为最后有效日，expire_day 落在区间内的未注销会员即为“跨日后新到期”
+ *  - 通过 ringAdvance 逐日取对应日桶，发出事件后将会员摘出桶环
+ *  - 区间超过桶环长度（长时间未运行）时退回全量扫描并重建桶环
+ */
+static void runExpiryForDays(long from_day, long to_day) {
+    if (to_day - from_day >= EXPIRY_RING_DAYS) {
+        for (Node* p = head; p; p = p->next) {
+            if (p->data.is_active == 1 && p->expire_day >= from_day && p->expire_day < to_day) {
+                emitExpiry(p);
+            }
+        }
+        ringRebuild(to_day);
+        return;
+    }
+    if (ring_base_day < from_day) ringAdvance(from_day, NULL);
+    ringAdvance(to_day, emitExpiry);
+}
+
+/*
+ * schedulerTick：调度器心跳
+ *  - 首次调用（或日期回拨）只记录今天并对齐桶环基准日，不补发历史到期
+ *  - 日期前进后处理新到期的会员，并推进 scheduler_last_day
+ */
+void schedulerTick() {
+    long today = clockToday();
+    if (scheduler_last_day == 0 || today < scheduler_last_day) {
+        if (ring_base_day != today) ringRebuild(today);
+        scheduler_last_day = today;
+        return;
+    }
+    if (today == scheduler_last_day) return;
+
+    runExpiryForDays(scheduler_last_day, today);
+    scheduler_last_day = today;
+}
+
+/* expiryConsoleListener：到期事件控制台提示 */
+static void expiryConsoleListener(const Node* p, long expire_day, void* ctx) {
+    (void)ctx;
+    char date[12];
+    daysToDate(expire_day, date);
+    printf("[到期] 卡号:%d 姓名:%s 类型:%s 已于 %s 到期。\n",
+           p->data.card_id, p->data.name, p->data.membership_type, date);
+}
+
+/* expiryLogListener：到期事件追加写入日志文件（ctx 为文件名），格式：到期日|卡号|姓名|类型 */
+static void expiryLogListener(const Node* p, long expire_day, void* ctx) {
+    FILE* fp = fopen((const char*)ctx, "ab");
+    if (!fp) return;
+    char date[12];
+    daysToDate(expire_day, date);
+    fprintf(fp, "%s|%d|%s|%s\n", date, p->data.card_id, p->data.name, p->data.membership_type);
+    fclose(fp);
+}
+
+/* =========================================================
+ *  会员变更通知：增删改时通知订阅者
+ *  说明：appendNode（新增/加载）、refreshExpiryIndexes（续费/注销）、修改电话、removeMember、
+ *       freeAllMembers 各自发出一条通知；订阅者据此增量维护派生数据，无需重新扫描全体会员
+ * ========================================================= */
+
+/* 变更通知订阅者 */
+static struct {
+    ChangeListener fn;
+    void* ctx;
+} change_listeners[MAX_CHANGE_LISTENERS];
+static int change_listener_count = 0;
+
+/* changeSubscribe：注册变更通知回调；订阅者已满返回 0 */
+int changeSubscribe(ChangeListener fn, void* ctx) {
+    if (change_listener_count >= MAX_CHANGE_LISTENERS) return 0;
+    change_listeners[change_listener_count].fn = fn;
+    change_listeners[change_listener_count].ctx = ctx;
+    change_listener_count++;
+    return 1;
+}
+
+/* emitChange：向全部订阅者分发一条变更通知 */
+static void emitChange(ChangeKind kind, Node* p) {
+    for (int i = 0; i < change_listener_count; i++) {
+        change_listeners[i].fn(kind, p, change_listeners[i].ctx);
+    }
+}
+
+/* =========================================================
+ *  文件持久化：读取与写回 members.txt
+ * ========================================================= */
 
 static void trim_newline(char* s) {
     s[strcspn(s, "\r\n")] = '\0';
@@ -369,7 +1907,10 @@ static void trim_newline(char* s) {
  * 关键点：
  *  - 每行按 '|' 分割字段，并进行基本合法性校验
  *  - 读取完成后更新 next_card_id，避免新增卡号重复
- *  - 最后执行一次 syncAutoExpire，确保状态与当前时间一致
+ *  - 到期状态在读取时按 expire_day 判定，加载阶段无需同步
+ *  - 旧格式记录（缺少 renew_periods）按固定天数的原到期日换算为 bonus_days，到期日保持不变
+ *  - 超出 MAX_MEMBERS 或内存不足而未能载入的记录不会静默丢弃：计数后在 stderr 警告，
+ *    其卡号仍计入 next_card_id 与布隆过滤器，避免重复发放
  */
 int loadFromFile(const char* filename) {
     FILE* fp = fopen(filename, "rb");
@@ -379,6 +1920,7 @@ int loadFromFile(const char* filename) {
 
     char line[512];
     int loaded = 0;
+    int dropped = 0;
     int max_id = 1000;
 
     while (fgets(line, sizeof(line), fp)) {
@@ -397,6 +1939,7 @@ int loadFromFile(const char* filename) {
         tok = strtok(NULL, "|"); if (!tok) continue; char mtype[10]; strncpy(mtype, tok, sizeof(mtype)); mtype[9] = '\0';
         tok = strtok(NULL, "|"); if (!tok) continue; int is_active = atoi(tok);
         tok = strtok(NULL, "|"); if (!tok) continue; long bonus_days = atol(tok);
+        tok = strtok(NULL, "|"); int legacy = (tok == NULL); long renew_periods = tok ? atol(tok) : 0;
 
         /* 基本数据合法性校验：避免错误数据进入系统 */
         if (card_id <= 0) continue;
@@ -406,8 +1949,9 @@ int loadFromFile(const char* filename) {
         if (getDurationDays(mtype) == 0) continue;
         if (!(is_active == 0 || is_active == 1)) continue;
         if (dateToDays(join_date) == 0) continue;
+        if (renew_periods < 0 || renew_periods > 1000) continue;
 
-        if (member_count >= MAX_MEMBERS) break;
+        if (card_id > max_id) max_id = card_id;
 
         Member m;
         m.card_id = card_id;
@@ -419,562 +1963,3053 @@ int loadFromFile(const char* filename) {
         strcpy(m.membership_type, mtype);
         m.is_active = is_active;
 
-        Node* node = createNode(&m);
-        if (!node) break;
+        if (findByCardID(card_id)) continue;     /* 重复卡号：保留首条记录 */
+
+        Node* node = member_count < MAX_MEMBERS ? createNode(&m) : NULL;
+        if (!node) { dropped++; bloomAdd(card_id); continue; }
+        node->renew_periods = (int)renew_periods;
         node->bonus_days = bonus_days;
+        if (legacy) {
+            /* 旧格式：到期日 = 入会日 + 固定天数 + bonus_days，换算为自然月之外的天数差 */
+            long join_days = dateToDays(join_date);
+            node->bonus_days += join_days + getDurationDays(mtype)
+                              - addMonthsToDays(join_days, getDurationMonths(mtype));
+        }
+        updateExpireDay(node);
 
-        appendNode(node);
+        if (!appendNode(node)) { freeNode(node); dropped++; bloomAdd(card_id); continue; }
         loaded++;
-
-        if (card_id > max_id) max_id = card_id;
     }
 
     fclose(fp);
+    if (dropped > 0) {
+        fprintf(stderr, "警告：%s 中有 %d 条记录超出会员上限（%d）或内存不足，未能载入；"
+                        "保存时这些记录将不会写回。\n", filename, dropped, MAX_MEMBERS);
+    }
 
     next_card_id = max_id + 1;
-    syncAutoExpire();
     return loaded;
 }
 
+/* writeMembers：按数据文件格式逐行写入输出缓冲（card_id|name|...|bonus_days|renew_periods）；写入出错返回 0 */
+static int writeMembers(FILE* fp) {
+    OutBuf ob;
+    obInit(&ob, fp);
+    for (Node* p = head; p; p = p->next) {
+        obLong(&ob, p->data.card_id);          obPutc(&ob, '|');
+        obPuts(&ob, p->data.name);             obPutc(&ob, '|');
+        obPuts(&ob, p->data.gender);           obPutc(&ob, '|');
+        obLong(&ob, p->data.age);              obPutc(&ob, '|');
+        obPuts(&ob, p->data.phone);            obPutc(&ob, '|');
+        obPuts(&ob, p->data.join_date);        obPutc(&ob, '|');
+        obPuts(&ob, p->data.membership_type);  obPutc(&ob, '|');
+        obPutc(&ob, (char)('0' + p->data.is_active)); obPutc(&ob, '|');
+        obLong(&ob, p->bonus_days);            obPutc(&ob, '|');
+        obLong(&ob, p->renew_periods);         obPutc(&ob, '\n');
+    }
+    return obFlush(&ob) && !ferror(fp);
+}
+
 /*
  * saveToFile：将链表数据写入 members.txt
  * 关键语句说明：
  *  - 先写 TEMP_FILE，再 rename 覆盖 DATA_FILE
  *  - 这种策略可降低写入过程中断导致的文件损坏风险
+ *  - 数据文件写入成功后同步写回布隆过滤器文件
  */
 int saveToFile(const char* filename) {
     FILE* fp = fopen(TEMP_FILE, "wb");
     if (!fp) return 0;
 
-    for (Node* p = head; p; p = p->next) {
-        fprintf(fp, "%d|%s|%s|%d|%s|%s|%s|%d|%ld\n",
-                p->data.card_id,
-                p->data.name,
-                p->data.gender,
-                p->data.age,
-                p->data.phone,
-                p->data.join_date,
-                p->data.membership_type,
-                p->data.is_active,
-                p->bonus_days);
-    }
-
-    fclose(fp);
+    int ok = writeMembers(fp);
+    if (fclose(fp) != 0) ok = 0;
+    if (!ok) { remove(TEMP_FILE); return 0; }
 
     remove(filename);
     if (rename(TEMP_FILE, filename) != 0) {
         remove(TEMP_FILE);
         return 0;
     }
-    return 1;
+    return saveBloom(BLOOM_FILE);
 }
 
 /* =========================================================
- *  菜单显示函数：负责交互入口显示
+ *  已发放卡号布隆过滤器：持久化到 members.bloom
+ *  目的：卡号不在内存中时，无需读取磁盘即可判定“从未发放”
+ *       （布隆过滤器无漏判；“可能发放过”存在少量误判）
  * ========================================================= */
 
-void printMainMenu() {
-    printf("\n=============================\n");
-    printf("    健身房会员管理系统\n");
-    printf("=============================\n");
-    printf("1. 显示所有会员\n");
-    printf("2. 会员信息管理\n");
-    printf("3. 查询会员\n");
-    printf("4. 会员状态更新(注销/过期)\n");
-    printf("5. 统计分析\n");
-    printf("0. 退出系统\n");
-    printf("=============================\n");
+/* bloomHash：卡号 -> 64 位混合散列（splitmix64 终结函数），高低 32 位用于双重散列 */
+static uint64_t bloomHash(int id) {
+    uint64_t x = (uint64_t)(uint32_t)id + 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
 }
 
-void printManageMenu() {
-    printf("\n------- 会员信息管理 -------\n");
-    printf("1. 新增会员\n");
-    printf("2. 修改会员信息 (仅限联系方式)\n");
-    printf("3. 删除会员 (仅限已过期/已注销)\n");
-    printf("4. 会员续费/延长 (月卡/季卡/年卡)\n");
-    printf("0. 返回主菜单\n");
-    printf("---------------------------\n");
+/* bloomTestBits：在给定位图中检查卡号的全部散列位 */
+static int bloomTestBits(const uint8_t* bits, uint32_t nbits, int id) {
+    uint64_t h = bloomHash(id);
+    uint32_t h1 = (uint32_t)h, h2 = (uint32_t)(h >> 32) | 1u;
+    for (uint32_t i = 0; i < BLOOM_HASHES; i++) {
+        uint32_t bit = (h1 + i * h2) & (nbits - 1);
+        if (!(bits[bit >> 3] & (1u << (bit & 7)))) return 0;
+    }
+    return 1;
 }
 
-void printSearchMenu() {
-    printf("\n------- 查询会员 -------\n");
-    printf("1. 按卡号查询\n");
-    printf("2. 按姓名查询 (模糊)\n");
-    printf("0. 返回主菜单\n");
-    printf("-----------------------\n");
+/* bloomSetBits：在给定位图中置位卡号的全部散列位 */
+static void bloomSetBits(uint8_t* bits, uint32_t nbits, int id) {
+    uint64_t h = bloomHash(id);
+    uint32_t h1 = (uint32_t)h, h2 = (uint32_t)(h >> 32) | 1u;
+    for (uint32_t i = 0; i < BLOOM_HASHES; i++) {
+        uint32_t bit = (h1 + i * h2) & (nbits - 1);
+        bits[bit >> 3] |= (uint8_t)(1u << (bit & 7));
+    }
 }
 
-/* =========================================================
- *  业务功能函数实现
- * ========================================================= */
+/* bloomBitsFor：最大卡号为 max_id 时需要的位数（每卡号约 BLOOM_BITS_PER_KEY 位，取 2 的幂） */
+static uint32_t bloomBitsFor(int max_id) {
+    uint32_t nbits = BLOOM_MIN_BITS;
+    while (nbits < BLOOM_MAX_BITS && (uint64_t)max_id * BLOOM_BITS_PER_KEY > nbits) nbits <<= 1;
+    return nbits;
+}
 
 /*
- * showAllMembers：列表显示全部会员
- * 关键点：
- *  - 先同步到期状态（syncAutoExpire）
- *  - 对有效会员计算剩余天数；对过期会员显示 ---
- *  - 使用 printWithPad 实现中英文混排对齐
+ * bloomResize：把过滤器重建为 nbits 位
+ * 关键点：原始卡号集合不可还原，因此枚举 1..bloom_max_id，把旧位图判定“可能发放过”的卡号写入新位图；
+ *        不会产生漏判，旧位图的误判会随之保留（扩容时旧位图处于满载附近，约 1.2%）
+ * 返回值：成功 1；内存不足返回 0 并保持原位图
  */
-void showAllMembers() {
-    syncAutoExpire();
-
-    if (member_count == 0) {
-        printf("\n暂无会员信息。\n");
-        return;
+static int bloomResize(uint32_t nbits) {
+    uint8_t* bits = (uint8_t*)calloc(nbits / 8, 1);
+    if (!bits) return 0;
+    if (issued_bloom) {
+        for (int id = 1; id <= bloom_max_id; id++) {
+            if (bloomTestBits(issued_bloom, bloom_bits, id)) bloomSetBits(bits, nbits, id);
+        }
+        free(issued_bloom);
     }
+    issued_bloom = bits;
+    bloom_bits = nbits;
+    return 1;
+}
 
-    char current_date_str[12];
-    getSystemDate(current_date_str);
-    long current_days = dateToDays(current_date_str);
+/* bloomAdd：记录一个已发放卡号；最大卡号超出当前容量时先扩容重建（扩容失败则沿用原位图，仅误判率升高） */
+void bloomAdd(int id) {
+    if (id <= 0) return;
+    if (id > bloom_max_id) {
+        uint32_t need = bloomBitsFor(id);
+        if (need > bloom_bits) bloomResize(need);
+        bloom_max_id = id;
+    }
+    if (issued_bloom) bloomSetBits(issued_bloom, bloom_bits, id);
+}
 
-    printf("\n>>> 会员列表 (当前日期: %s)\n", current_date_str);
-    printSeparator();
+/* bloomMayContain：返回 0 表示该卡号一定从未发放；返回 1 表示可能发放过（位图未能分配时保守返回 1） */
+int bloomMayContain(int id) {
+    if (id <= 0 || id > bloom_max_id) return 0;
+    if (!issued_bloom) return 1;
+    return bloomTestBits(issued_bloom, bloom_bits, id);
+}
 
-    printWithPad("卡号", W_CARD);       putchar(' ');
-    printWithPad("姓名", W_NAME);       putchar(' ');
-    printWithPad("性别", W_GENDER);     putchar(' ');
-    printWithPad("年龄", W_AGE);        putchar(' ');
-    printWithPad("电话", W_PHONE);      putchar(' ');
-    printWithPad("入会日期", W_DATE);   putchar(' ');
-    printWithPad("类型", W_TYPE);       putchar(' ');
-    printWithPad("状态", W_STATUS);     putchar(' ');
-    printWithPad("剩余天数", W_LEFT);   putchar('\n');
+/*
+ * 布隆过滤器文件格式：文件头 "GBF1" + 位数（uint32）+ 最大卡号（int32），其后为位图
+ * 旧格式为无文件头的 8KB 位图，读取时枚举 1..BLOOM_LEGACY_SCAN 把命中的卡号并入当前过滤器
+ */
+static const char bloom_magic[4] = {'G', 'B', 'F', '1'};
 
-    printSeparator();
+/* loadBloom：读取布隆过滤器文件并并入当前过滤器；文件不存在或格式不符时保持当前内容并返回 0 */
+int loadBloom(const char* filename) {
+    FILE* fp = fopen(filename, "rb");
+    if (!fp) return 0;
 
-    for (Node* p = head; p; p = p->next) {
-        char remain_str[32] = "---";
-        if (p->data.is_active == 1) {
-            long expire_days = calcExpireDays(p);
-            long days_left = expire_days - current_days;
-            sprintf(remain_str, "%ld 天", days_left);
+    char magic[4];
+    uint32_t nbits = 0;
+    int32_t max_id = 0;
+    uint8_t* bits = NULL;
+    int ok = 0;
+    int legacy = !(fread(magic, 1, sizeof(magic), fp) == sizeof(magic) && memcmp(magic, bloom_magic, 4) == 0);
+    if (!legacy) {
+        if (fread(&nbits, sizeof(nbits), 1, fp) == 1 && fread(&max_id, sizeof(max_id), 1, fp) == 1 &&
+            nbits >= BLOOM_MIN_BITS && nbits <= BLOOM_MAX_BITS && (nbits & (nbits - 1)) == 0 && max_id >= 0) {
+            bits = (uint8_t*)malloc(nbits / 8);
+            ok = bits && fread(bits, 1, nbits / 8, fp) == nbits / 8 && fgetc(fp) == EOF;
         }
-
-        printf("%-*d ", W_CARD, p->data.card_id);
-        printWithPad(p->data.name, W_NAME);                         putchar(' ');
-        printWithPad(p->data.gender, W_GENDER);                     putchar(' ');
-        printf("%-*d ", W_AGE, p->data.age);
-        printf("%-*s ", W_PHONE, p->data.phone);
-        printf("%-*s ", W_DATE, p->data.join_date);
-        printWithPad(p->data.membership_type, W_TYPE);              putchar(' ');
-        printWithPad(p->data.is_active ? "有效" : "过期", W_STATUS); putchar(' ');
-        printWithPad(remain_str, W_LEFT);                           putchar('\n');
+    } else {
+        /* 旧格式：整个文件即 8KB 位图 */
+        rewind(fp);
+        nbits = BLOOM_LEGACY_BYTES * 8;
+        max_id = BLOOM_LEGACY_SCAN;
+        bits = (uint8_t*)malloc(BLOOM_LEGACY_BYTES);
+        ok = bits && fread(bits, 1, BLOOM_LEGACY_BYTES, fp) == BLOOM_LEGACY_BYTES && fgetc(fp) == EOF;
     }
+    fclose(fp);
+    if (!ok) { free(bits); return 0; }
 
-    printSeparator();
+    if (!legacy && !issued_bloom && bloom_max_id == 0) {
+        issued_bloom = bits;           /* 启动时过滤器为空：直接采用文件内容 */
+        bloom_bits = nbits;
+        bloom_max_id = max_id;
+        return 1;
+    }
+    for (int id = 1; id <= max_id; id++) {
+        if (bloomTestBits(bits, nbits, id)) bloomAdd(id);
+    }
+    free(bits);
+    return 1;
+}
+
+/* saveBloom：写回布隆过滤器（文件头 + 位图，同样采用临时文件 + rename 策略） */
+int saveBloom(const char* filename) {
+    if (!issued_bloom && !bloomResize(BLOOM_MIN_BITS)) return 0;
+
+    FILE* fp = fopen(BLOOM_TEMP_FILE, "wb");
+    if (!fp) return 0;
+
+    int32_t max_id = bloom_max_id;
+    int ok = fwrite(bloom_magic, 1, sizeof(bloom_magic), fp) == sizeof(bloom_magic) &&
+             fwrite(&bloom_bits, sizeof(bloom_bits), 1, fp) == 1 &&
+             fwrite(&max_id, sizeof(max_id), 1, fp) == 1 &&
+             fwrite(issued_bloom, 1, bloom_bits / 8, fp) == bloom_bits / 8;
+    if (fclose(fp) != 0) ok = 0;
+    if (!ok) { remove(BLOOM_TEMP_FILE); return 0; }
+
+    remove(filename);
+    if (rename(BLOOM_TEMP_FILE, filename) != 0) {
+        remove(BLOOM_TEMP_FILE);
+        return 0;
+    }
+    return 1;
+}
+
+/* cardNotFoundReason：查无此卡的简短原因（批量处理用） */
+static const char* cardNotFoundReason(int id) {
+    return bloomMayContain(id) ? "卡号可能曾发放（会员可能已删除）" : "卡号从未发放";
+}
+
+/*
+ * reportCardNotFound：内存中查无此卡时，借助布隆过滤器区分“一定从未发放”与“可能已删除”
+ * 说明：布隆过滤器命中只表示“可能发放过”（误判率不超过约 1.2%），因此不能断言会员已删除
+ */
+static void reportCardNotFound(int id) {
+    char msg[96];
+    if (!bloomMayContain(id)) snprintf(msg, sizeof(msg), "卡号 %d 从未发放。", id);
+    else snprintf(msg, sizeof(msg), "未找到卡号 %d（该卡号可能曾发放，会员可能已删除）。", id);
+    outputError(msg);
+}
+
+/* =========================================================
+ *  组合查询引擎：条件文本 -> 谓词流水线 -> 在会员库上求值
+ *  语法：若干以空格分隔的条件，全部满足（AND）才算匹配
+ *    card=1001 / card=1001-1100 / card>=1001 / card<=1100
+ *    age=25 / age=20-30 / age>=20 / age<=30
+ *    joined=2026-01-01 / joined>=2026-01-01 / joined<=2026-12-31
+ *    gender=男   type=年卡   status=active|expired   name~关键字
+ * ========================================================= */
+
+/* parseLongRange：解析 "a" 或 "a-b" 形式的整数闭区间 */
+static int parseLongRange(const char* s, long* lo, long* hi) {
+    char* end;
+    *lo = strtol(s, &end, 10);
+    if (end == s) return 0;
+    if (*end == '\0') { *hi = *lo; return 1; }
+    if (*end != '-') return 0;
+    const char* s2 = end + 1;
+    *hi = strtol(s2, &end, 10);
+    return end != s2 && *end == '\0' && *lo <= *hi;
+}
+
+/* parseLongValue：解析单个整数值（不允许尾随字符） */
+static int parseLongValue(const char* s, long* v) {
+    char* end;
+    *v = strtol(s, &end, 10);
+    return end != s && *end == '\0';
+}
+
+/*
+ * applyBound：将比较运算符作用到闭区间上
+ * op 取值：'=' 精确/区间，'>' 表示 >=，'<' 表示 <=
+ */
+static void applyBound(char op, long lo, long hi, long* out_lo, long* out_hi) {
+    if (op == '=') { if (lo > *out_lo) *out_lo = lo; if (hi < *out_hi) *out_hi = hi; }
+    else if (op == '>') { if (lo > *out_lo) *out_lo = lo; }
+    else { if (hi < *out_hi) *out_hi = hi; }
+}
+
+/*
+ * compileQuery：将条件文本编译为 Query
+ * 关键点：
+ *  - card 条件合并为索引扫描区间，其余条件生成谓词
+ *  - 同一数值字段的多个条件合并为一个区间谓词（如 age>=20 age<=30）
+ *  - 最后按字段求值代价排序，保证廉价条件先过滤
+ * 返回值：1 成功；0 失败（err 中写入出错的条件）
+ */
+int compileQuery(const char* text, long today, Query* q, char* err, size_t err_size) {
+    char buf[256];
+    strncpy(buf, text, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+
+    q->count = 0;
+    q->card_lo = 0;
+    q->card_hi = 0x7FFFFFFF;
+    q->today = today;
+
+    for (char* tok = strtok(buf, " \t"); tok; tok = strtok(NULL, " \t")) {
+        char* opp = strpbrk(tok, "=<>~");
+        if (!opp || opp == tok) { snprintf(err, err_size, "%s", tok); return 0; }
+
+        char key[16];
+        size_t klen = (size_t)(opp - tok);
+        if (klen >= sizeof(key)) { snprintf(err, err_size, "%s", tok); return 0; }
+        memcpy(key, tok, klen);
+        key[klen] = '\0';
+
+        char op;
+        const char* val;
+        if (opp[0] == '~') { op = '~'; val = opp + 1; }
+        else if (opp[0] == '=') { op = '='; val = opp + 1; }
+        else if (opp[1] == '=') { op = opp[0]; val = opp + 2; }
+        else { snprintf(err, err_size, "%s", tok); return 0; }
+        if (*val == '\0') { snprintf(err, err_size, "%s", tok); return 0; }
+
+        long lo = 0, hi = 0;
+
+        if (strcmp(key, "card") == 0) {
+            long clo = q->card_lo, chi = q->card_hi;
+            if (op == '=' ? !parseLongRange(val, &lo, &hi) : op == '~' || !parseLongValue(val, &lo)) {
+                snprintf(err, err_size, "%s", tok); return 0;
+            }
+            if (op != '=') hi = lo;
+            if (lo < 0 || hi > 0x7FFFFFFFL) { snprintf(err, err_size, "%s", tok); return 0; }   /* 超出卡号范围 */
+            applyBound(op, lo, hi, &clo, &chi);
+            q->card_lo = (int)clo;
+            q->card_hi = (int)chi;
+            continue;
+        }
+
+        QueryPred pred;
+        memset(&pred, 0, sizeof(pred));
+        pred.lo = -0x7FFFFFFFL;
+        pred.hi = 0x7FFFFFFFL;
+
+        if (strcmp(key, "age") == 0) {
+            pred.field = Q_AGE;
+            if (op == '=' ? !parseLongRange(val, &lo, &hi) : op == '~' || !parseLongValue(val, &lo)) {
+                snprintf(err, err_size, "%s", tok); return 0;
+            }
+            if (op != '=') hi = lo;
+        } else if (strcmp(key, "joined") == 0) {
+            pred.field = Q_JOINED;
+            lo = hi = dateToDays(val);
+            if (op == '~' || lo == 0) { snprintf(err, err_size, "%s", tok); return 0; }
+        } else if (strcmp(key, "gender") == 0 || strcmp(key, "type") == 0 || strcmp(key, "name") == 0) {
+            pred.field = key[0] == 'g' ? Q_GENDER : key[0] == 't' ? Q_TYPE : Q_NAME;
+            if ((pred.field == Q_NAME) != (op == '~') || strlen(val) >= sizeof(pred.text)) {
+                snprintf(err, err_size, "%s", tok); return 0;
+            }
+            if (pred.field == Q_NAME) foldNameKey(val, pred.text, sizeof(pred.text));
+            else strcpy(pred.text, val);
+        } else if (strcmp(key, "status") == 0) {
+            pred.field = Q_STATUS;
+            if (op != '=') { snprintf(err, err_size, "%s", tok); return 0; }
+            if (strcmp(val, "active") == 0) pred.lo = pred.hi = 1;
+            else if (strcmp(val, "expired") == 0) pred.lo = pred.hi = 0;
+            else { snprintf(err, err_size, "%s", tok); return 0; }
+        } else {
+            snprintf(err, err_size, "%s", tok);
+            return 0;
+        }
+
+        /* 数值字段：与已有同字段谓词合并区间 */
+        if (pred.field == Q_AGE || pred.field == Q_JOINED) {
+            int merged = 0;
+            for (int i = 0; i < q->count; i++) {
+                if (q->preds[i].field == pred.field) {
+                    applyBound(op, lo, hi, &q->preds[i].lo, &q->preds[i].hi);
+                    merged = 1;
+                    break;
+                }
+            }
+            if (merged) continue;
+            applyBound(op, lo, hi, &pred.lo, &pred.hi);
+        }
+
+        if (q->count >= MAX_QUERY_PREDS) { snprintf(err, err_size, "%s", tok); return 0; }
+        q->preds[q->count++] = pred;
+    }
+
+    /* 按求值代价升序排列（插入排序，条件数很少） */
+    for (int i = 1; i < q->count; i++) {
+        QueryPred t = q->preds[i];
+        int j = i - 1;
+        while (j >= 0 && q->preds[j].field > t.field) { q->preds[j + 1] = q->preds[j]; j--; }
+        q->preds[j + 1] = t;
+    }
+    return 1;
+}
+
+/* matchPred：单个谓词求值 */
+static int matchPred(const QueryPred* pr, Node* p, long today) {
+    switch (pr->field) {
+        case Q_AGE:    return p->data.age >= pr->lo && p->data.age <= pr->hi;
+        case Q_GENDER: return strcmp(p->data.gender, pr->text) == 0;
+        case Q_TYPE:   return strcmp(p->data.membership_type, pr->text) == 0;
+        case Q_JOINED: return p->join_day >= pr->lo && p->join_day <= pr->hi;
+        case Q_STATUS: {
+            return isMemberActive(p, today) == pr->lo;
+        }
+        case Q_NAME:   return strstr(p->name_key, pr->text) != NULL;
+    }
+    return 0;
+}
+
+/*
+ * runQuery：执行查询，对每个匹配结点调用 visit，返回匹配数量
+ * 关键点：扫描范围由 card_index 二分确定，只遍历卡号区间内的结点
+ */
+int runQuery(const Query* q, void (*visit)(Node* p, void* ctx), void* ctx) {
+    if (q->card_lo > q->card_hi) return 0;
+
+    int matched = 0;
+    for (int i = cardIndexLowerBound(q->card_lo); i < member_count; i++) {
+        Node* p = card_index[i];
+        if (p->data.card_id > q->card_hi) break;
+
+        int ok = 1;
+        for (int k = 0; k < q->count && ok; k++) ok = matchPred(&q->preds[k], p, q->today);
+        if (!ok) continue;
+
+        if (visit) visit(p, ctx);
+        matched++;
+    }
+    return matched;
+}
+
+/* =========================================================
+ *  最近到期前 K 名：有界最大堆，O(n log k)，无需对全体会员排序
+ * ========================================================= */
+
+/* expiryLater：a 是否比 b 更晚到期（剩余天数相同按卡号比较，保证结果稳定） */
+static int expiryLater(const ExpiryEntry* a, const ExpiryEntry* b) {
+    if (a->days_left != b->days_left) return a->days_left > b->days_left;
+    return a->node->data.card_id > b->node->data.card_id;
+}
+
+/* expiryHeapSiftDown：最大堆下沉（堆顶为当前 K 名中最晚到期者） */
+static void expiryHeapSiftDown(ExpiryEntry* h, int n, int i) {
+    while (1) {
+        int l = 2 * i + 1, r = l + 1, m = i;
+        if (l < n && expiryLater(&h[l], &h[m])) m = l;
+        if (r < n && expiryLater(&h[r], &h[m])) m = r;
+        if (m == i) return;
+        ExpiryEntry t = h[i]; h[i] = h[m]; h[m] = t;
+        i = m;
+    }
+}
+
+/* expiryHeapSiftUp：最大堆上浮 */
+static void expiryHeapSiftUp(ExpiryEntry* h, int i) {
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!expiryLater(&h[i], &h[parent])) return;
+        ExpiryEntry t = h[i]; h[i] = h[parent]; h[parent] = t;
+        i = parent;
+    }
+}
+
+/*
+ * topKExpiring：找出剩余天数最少的前 k 名有效会员
+ * 关键点：
+ *  - out 作为容量为 k 的最大堆；新条目早于堆顶时替换堆顶并下沉
+ *  - 扫描结束后原地堆排序，输出按剩余天数升序
+ * 返回值：实际写入 out 的条目数（<= k）
+ */
+int topKExpiring(long today, int k, ExpiryEntry* out) {
+    if (k <= 0) return 0;
+
+    int n = 0;
+    for (Node* p = head; p; p = p->next) {
+        if (!isMemberActive(p, today)) continue;
+        long days_left = calcExpireDays(p) - today;
+
+        ExpiryEntry e = { days_left, p };
+        if (n < k) {
+            out[n] = e;
+            expiryHeapSiftUp(out, n++);
+        } else if (expiryLater(&out[0], &e)) {
+            out[0] = e;
+            expiryHeapSiftDown(out, n, 0);
+        }
+    }
+
+    /* 堆排序：依次把堆顶（最晚到期）换到末尾，得到升序序列 */
+    for (int end = n - 1; end > 0; end--) {
+        ExpiryEntry t = out[0]; out[0] = out[end]; out[end] = t;
+        expiryHeapSiftDown(out, end, 0);
+    }
+    return n;
+}
+
+/* =========================================================
+ *  流式导出：CSV / JSON Lines
+ *  目的：会员列表、查询结果与统计报表可导出给表格或脚本处理；
+ *       边遍历边写入定长输出缓冲，内存占用与会员数无关
+ * ========================================================= */
+
+/* obCsvField：写入一个 CSV 字段；含逗号、引号或换行时加引号，字段内引号写两次 */
+static void obCsvField(OutBuf* ob, const char* s) {
+    if (!s[strcspn(s, ",\"\r\n")]) { obPuts(ob, s); return; }
+    obPutc(ob, '"');
+    for (const char* c = s; *c; c++) {
+        if (*c == '"') obPutc(ob, '"');
+        obPutc(ob, *c);
+    }
+    obPutc(ob, '"');
+}
+
+/*
+ * obJsonString：写入带引号的 JSON 字符串；转义引号、反斜杠与控制字符，UTF-8 原样写出
+ * 说明：无需转义的连续片段整段写入，只有需转义的字节单独处理
+ */
+static void obJsonString(OutBuf* ob, const char* s) {
+    static const char hex[] = "0123456789abcdef";
+    obPutc(ob, '"');
+    for (;;) {
+        size_t run = 0;
+        while ((unsigned char)s[run] >= 0x20 && s[run] != '"' && s[run] != '\\') run++;
+        obWrite(ob, s, run);
+        s += run;
+        unsigned char c = (unsigned char)*s;
+        if (!c) break;
+        if (c == '"' || c == '\\') { obPutc(ob, '\\'); obPutc(ob, (char)c); }
+        else {
+            obPuts(ob, "\\u00");
+            obPutc(ob, hex[c >> 4]);
+            obPutc(ob, hex[c & 0x0F]);
+        }
+        s++;
+    }
+    obPutc(ob, '"');
+}
+
+/* 会员导出列：CSV 表头与 JSON 键名一致 */
+static const char* const export_member_cols[] = {
+    "card_id", "name", "gender", "age", "phone", "join_date",
+    "membership_type", "status", "expire_date", "days_left", "bonus_days",
+    "renew_periods"
+};
+#define EXPORT_MEMBER_COLS (int)(sizeof(export_member_cols) / sizeof(export_member_cols[0]))
+
+/* obExportKey：写入第 col 列的分隔与键名（CSV 只写逗号，JSON 写 ,"键": ，一次确保空间后直接拼入缓冲区） */
+static void obExportKey(OutBuf* ob, ExportFormat fmt, int col) {
+    if (fmt == EXPORT_CSV) {
+        if (col > 0) obPutc(ob, ',');
+        return;
+    }
+    const char* key = export_member_cols[col];
+    size_t n = strlen(key);
+    if (ob->len + n + 4 > sizeof(ob->data)) obFlush(ob);
+    char* d = ob->data + ob->len;
+    *d++ = col > 0 ? ',' : '{';
+    *d++ = '"';
+    memcpy(d, key, n);
+    d += n;
+    *d++ = '"';
+    *d++ = ':';
+    ob->len = (size_t)(d - ob->data);
+}
+
+/* obExportText：按格式写入文本字段 */
+static void obExportText(OutBuf* ob, ExportFormat fmt, const char* s) {
+    if (fmt == EXPORT_CSV) obCsvField(ob, s);
+    else obJsonString(ob, s);
+}
+
+/*
+ * writeExportFields：写入一个会员的全部导出字段（JSON 不含结尾的 }）
+ * 说明：status 为 active/expired/cancelled；非有效会员的 days_left 在 CSV 中留空、JSON 中为 null
+ */
+static void writeExportFields(OutBuf* ob, ExportFormat fmt, const Node* p, long today) {
+    char date[12];
+    daysToDate(p->expire_day, date);
+    int active = isMemberActive(p, today);
+    const char* status = active ? "active" : (p->data.is_active == 1 ? "expired" : "cancelled");
+
+    obExportKey(ob, fmt, 0);  obLong(ob, p->data.card_id);
+    obExportKey(ob, fmt, 1);  obExportText(ob, fmt, p->data.name);
+    obExportKey(ob, fmt, 2);  obExportText(ob, fmt, p->data.gender);
+    obExportKey(ob, fmt, 3);  obLong(ob, p->data.age);
+    obExportKey(ob, fmt, 4);  obExportText(ob, fmt, p->data.phone);
+    obExportKey(ob, fmt, 5);  obExportText(ob, fmt, p->data.join_date);
+    obExportKey(ob, fmt, 6);  obExportText(ob, fmt, p->data.membership_type);
+    obExportKey(ob, fmt, 7);  obExportText(ob, fmt, status);
+    obExportKey(ob, fmt, 8);  obExportText(ob, fmt, date);
+    obExportKey(ob, fmt, 9);
+    if (active) obLong(ob, p->expire_day - today);
+    else if (fmt == EXPORT_JSONL) obPuts(ob, "null");
+    obExportKey(ob, fmt, 10); obLong(ob, p->bonus_days);
+    obExportKey(ob, fmt, 11); obLong(ob, p->renew_periods);
+}
+
+/* writeExportRecord：写入一个会员的导出记录（一行） */
+static void writeExportRecord(OutBuf* ob, ExportFormat fmt, const Node* p, long today) {
+    writeExportFields(ob, fmt, p, today);
+    obPuts(ob, fmt == EXPORT_CSV ? "\n" : "}\n");
+}
+
+/* 导出遍历回调上下文 */
+typedef struct {
+    OutBuf* ob;
+    ExportFormat fmt;
+    long today;
+} ExportCtx;
+
+static void exportVisit(Node* p, void* ctx) {
+    ExportCtx* ec = (ExportCtx*)ctx;
+    writeExportRecord(ec->ob, ec->fmt, p, ec->today);
+}
+
+/*
+ * exportMembers：按卡号顺序导出会员（q 非 NULL 时只导出匹配的会员）
+ * 返回值：导出条数；写入失败返回 -1
+ */
+long exportMembers(FILE* fp, ExportFormat fmt, const Query* q, long today) {
+    OutBuf ob;
+    obInit(&ob, fp);
+
+    if (fmt == EXPORT_CSV) {
+        for (int c = 0; c < EXPORT_MEMBER_COLS; c++) {
+            if (c > 0) obPutc(&ob, ',');
+            obPuts(&ob, export_member_cols[c]);
+        }
+        obPutc(&ob, '\n');
+    }
+
+    ExportCtx ec = { &ob, fmt, today };
+    long count = 0;
+    if (q) {
+        count = runQuery(q, exportVisit, &ec);
+    } else {
+        for (int i = 0; i < member_count; i++) exportVisit(card_index[i], &ec);
+        count = member_count;
+    }
+    return obFlush(&ob) ? count : -1;
+}
+
+/* writeStatRow：写入一条统计记录 metric,bucket,type,value（bucket/type 为 NULL 时 CSV 留空、JSON 省略） */
+static void writeStatRow(OutBuf* ob, ExportFormat fmt, const char* metric,
+                         const char* bucket, const char* type, long value) {
+    if (fmt == EXPORT_CSV) {
+        obPuts(ob, metric);
+        obPutc(ob, ',');
+        if (bucket) obPuts(ob, bucket);
+        obPutc(ob, ',');
+        if (type) obCsvField(ob, type);
+        obPutc(ob, ',');
+        obLong(ob, value);
+        obPutc(ob, '\n');
+        return;
+    }
+    obPuts(ob, "{\"metric\":");    obJsonString(ob, metric);
+    if (bucket) { obPuts(ob, ",\"bucket\":"); obJsonString(ob, bucket); }
+    if (type)   { obPuts(ob, ",\"type\":");   obJsonString(ob, type); }
+    obPuts(ob, ",\"value\":");     obLong(ob, value);
+    obPuts(ob, "}\n");
+}
+
+/*
+ * exportStatistics：导出统计报表（与统计分析、剩余天数分布使用同一数据源）
+ * 内容：会员总数、有效会员数及类型构成、7/30/90 天内到期人数、按月（30 天）剩余天数分布
+ * 返回值：导出记录条数；统计失败（内存分配失败）或写入失败返回 -1
+ */
+long exportStatistics(FILE* fp, ExportFormat fmt, long today) {
+    static const char* types[MEMBER_TYPES] = {"月卡", "季卡", "年卡"};
+    static const int windows[] = {7, 30, 90};
+
+    int by_type[MEMBER_TYPES];
+    int active = countActiveByType(today, by_type);
+    if (active < 0) return -1;     /* 统计失败：不写出任何内容 */
+
+    OutBuf ob;
+    obInit(&ob, fp);
+    long rows = 0;
+
+    if (fmt == EXPORT_CSV) obPuts(&ob, "metric,bucket,type,value\n");
+
+    writeStatRow(&ob, fmt, "members", NULL, NULL, member_count);   rows++;
+    writeStatRow(&ob, fmt, "active", NULL, NULL, active);          rows++;
+    for (int t = 0; t < MEMBER_TYPES; t++, rows++) {
+        writeStatRow(&ob, fmt, "active", NULL, types[t], by_type[t]);
+    }
+
+    for (size_t w = 0; w < sizeof(windows) / sizeof(windows[0]); w++, rows++) {
+        char bucket[16];
+        memcpy(fmtLong(bucket, windows[w]), "d", 2);
+        writeStatRow(&ob, fmt, "expiring_within", bucket, NULL,
+                     forEachExpiring(today, windows[w], NULL, NULL));
+    }
+
+    ExpiryHistogram h;
+    buildHistogramIncremental(today, &h);
+    for (int m = 0; m < HIST_MONTHS; m++) {
+        char bucket[16];
+        char* e = fmtLong(bucket, (long)m * 30);
+        *e++ = '-';
+        e = fmtLong(e, m == HIST_MONTHS - 1 ? EXPIRY_RING_DAYS - 1 : (long)m * 30 + 29);
+        *e = '\0';
+        for (int t = 0; t < MEMBER_TYPES; t++, rows++) {
+            writeStatRow(&ob, fmt, "remaining_days", bucket, types[t], h.month[m][t]);
+        }
+    }
+    for (int t = 0; t < MEMBER_TYPES; t++, rows++) {
+        writeStatRow(&ob, fmt, "remaining_days", ">365", types[t], h.beyond[t]);
+    }
+
+    return obFlush(&ob) ? rows : -1;
+}
+
+/* =========================================================
+ *  菜单显示函数：负责交互入口显示
+ * ========================================================= */
+
+void printMainMenu() {
+    printf("\n=============================\n");
+    printf("    健身房会员管理系统\n");
+    printf("=============================\n");
+    printf("1. 显示所有会员\n");
+    printf("2. 会员信息管理\n");
+    printf("3. 查询会员\n");
+    printf("4. 会员状态更新(注销/过期)\n");
+    printf("5. 统计分析\n");
+    printf("6. 分页浏览会员\n");
+    printf("7. 最近到期会员 (前K名)\n");
+    printf("8. 续费提醒 (按到期窗口)\n");
+    printf("9. 剩余天数分布报表\n");
+    printf("10. 数据导出 (CSV / JSON Lines)\n");
+    printf("11. 实时统计看板 (%s)\n", dashboard.enabled ? "已开启，选择以关闭" : "开启");
+    printf("0. 退出系统\n");
+    printf("=============================\n");
+}
+
+void printManageMenu() {
+    printf("\n------- 会员信息管理 -------\n");
+    printf("1. 新增会员\n");
+    printf("2. 修改会员信息 (仅限联系方式)\n");
+    printf("3. 删除会员 (仅限已过期/已注销)\n");
+    printf("4. 会员续费/延长 (月卡/季卡/年卡)\n");
+    printf("5. 批量续费 (从文件导入)\n");
+    printf("0. 返回主菜单\n");
+    printf("---------------------------\n");
+}
+
+void printSearchMenu() {
+    printf("\n------- 查询会员 -------\n");
+    printf("1. 按卡号查询\n");
+    printf("2. 按姓名查询 (模糊)\n");
+    printf("3. 组合条件查询\n");
+    printf("0. 返回主菜单\n");
+    printf("-----------------------\n");
+}
+
+/* =========================================================
+ *  业务功能函数实现
+ * ========================================================= */
+
+/* renderMemberTableHeader：写入会员表格表头（含上下分隔线） */
+static void renderMemberTableHeader(OutBuf* ob) {
+    obSeparator(ob);
+
+    obTextPad(ob, "卡号", W_CARD);       obPutc(ob, ' ');
+    obTextPad(ob, "姓名", W_NAME);       obPutc(ob, ' ');
+    obTextPad(ob, "性别", W_GENDER);     obPutc(ob, ' ');
+    obTextPad(ob, "年龄", W_AGE);        obPutc(ob, ' ');
+    obTextPad(ob, "电话", W_PHONE);      obPutc(ob, ' ');
+    obTextPad(ob, "入会日期", W_DATE);   obPutc(ob, ' ');
+    obTextPad(ob, "类型", W_TYPE);       obPutc(ob, ' ');
+    obTextPad(ob, "状态", W_STATUS);     obPutc(ob, ' ');
+    obTextPad(ob, "剩余天数", W_LEFT);   obPutc(ob, '\n');
+
+    obSeparator(ob);
+}
+
+/* renderMemberRow：写入一行会员信息；active 为有效状态，有效会员显示剩余天数，否则显示 --- */
+static void renderMemberRow(OutBuf* ob, const Node* p, int active, long current_days) {
+    char remain_str[32] = "---";
+    if (active) {
+        long days_left = calcExpireDays(p) - current_days;
+        memcpy(fmtLong(remain_str, days_left), " 天", sizeof(" 天"));
+    }
+
+    char num[24];
+    obAsciiPad(ob, num, (size_t)(fmtLong(num, p->data.card_id) - num), W_CARD); obPutc(ob, ' ');
+    obNameCell(ob, p);                                           obPutc(ob, ' ');
+    obTextPad(ob, p->data.gender, W_GENDER);                     obPutc(ob, ' ');
+    obAsciiPad(ob, num, (size_t)(fmtLong(num, p->data.age) - num), W_AGE);      obPutc(ob, ' ');
+    obAsciiPad(ob, p->data.phone, strlen(p->data.phone), W_PHONE);              obPutc(ob, ' ');
+    obAsciiPad(ob, p->data.join_date, strlen(p->data.join_date), W_DATE);       obPutc(ob, ' ');
+    obTextPad(ob, p->data.membership_type, W_TYPE);              obPutc(ob, ' ');
+    obTextPad(ob, active ? "有效" : "过期", W_STATUS);            obPutc(ob, ' ');
+    obTextPad(ob, remain_str, W_LEFT);                           obPutc(ob, '\n');
+}
+
+/*
+ * renderMemberRowCached：写入一行会员信息，优先复用结点上缓存的排版结果
+ * 关键点：
+ *  - 缓存命中（row_day == today）时整行 memcpy
+ *  - 未命中时先确保缓冲区剩余空间容纳一整行，直接排版到输出缓冲，再把这段字节复制到缓存
+ */
+static void renderMemberRowCached(OutBuf* ob, Node* p, long today) {
+    if (p->row_day == today && p->row_cache) {
+        obWrite(ob, p->row_cache, (size_t)p->row_len);
+        return;
+    }
+
+    if (ob->len + ROW_CACHE_MAX > sizeof(ob->data)) obFlush(ob);
+    size_t start = ob->len;
+    renderMemberRow(ob, p, isMemberActive(p, today), today);
+    size_t len = ob->len - start;
+    if (len > ROW_CACHE_MAX) return;
+
+    if (!p->row_cache || (size_t)p->row_len != len) {
+        char* grown = (char*)realloc(p->row_cache, len);
+        if (!grown) return;
+        p->row_cache = grown;
+    }
+    memcpy(p->row_cache, ob->data + start, len);
+    p->row_len = (int)len;
+    p->row_day = today;
+}
+
+/* =========================================================
+ *  输出后端：表格 / 纯文本 / 机器可读
+ *  目的：列表、查询与统计界面只描述“输出什么”，由当前后端决定“怎么输出”；
+ *       三种后端写入同一个输出缓冲区，启动参数 --output 选择：
+ *   - table   按视觉宽度对齐的表格（默认）
+ *   - plain   不补齐的纯文本，字段以 " | " 分隔，适合非等宽字体显示或复制粘贴
+ *   - machine JSON Lines（会员字段与导出一致），不计算显示宽度、不补齐，标题与提示不输出
+ * ========================================================= */
+
+/* textTitle：标题前空一行（表格与纯文本共用） */
+static void textTitle(OutBuf* ob, const char* text) {
+    obPutc(ob, '\n');
+    obPuts(ob, text);
+    obPutc(ob, '\n');
+}
+
+/* textNote：提示文字独占一行（表格与纯文本共用） */
+static void textNote(OutBuf* ob, const char* text) {
+    obPuts(ob, text);
+    obPutc(ob, '\n');
+}
+
+/* textMemberDetail：逐行输出“字段: 值”形式的会员详情（表格与纯文本共用） */
+static void textMemberDetail(OutBuf* ob, const Node* p, long today) {
+    int active = isMemberActive(p, today);
+    obPuts(ob, "卡号: ");      obLong(ob, p->data.card_id);          obPutc(ob, '\n');
+    obPuts(ob, "姓名: ");      obPuts(ob, p->data.name);             obPutc(ob, '\n');
+    obPuts(ob, "类型: ");      obPuts(ob, p->data.membership_type);  obPutc(ob, '\n');
+    obPuts(ob, "状态: ");      obPuts(ob, active ? "有效" : "过期");   obPutc(ob, '\n');
+    obPuts(ob, "入会日期: ");  obPuts(ob, p->data.join_date);        obPutc(ob, '\n');
+    obPuts(ob, "剩余天数: ");
+    if (active) { obLong(ob, calcExpireDays(p) - today); obPuts(ob, " 天\n"); }
+    else obPuts(ob, "---\n");
+}
+
+/* textReportCount：计数项；分类计数附带占比（total 为 0 时不计算） */
+static void textReportCount(OutBuf* ob, const char* type, const char* label, long value, long total, const char* indent) {
+    obPuts(ob, indent);
+    obPuts(ob, type ? type : label);
+    obPuts(ob, ": ");
+    obLong(ob, value);
+    if (!type) { obPuts(ob, " 人\n"); return; }
+    if (total > 0) {
+        char pct[32];
+        snprintf(pct, sizeof(pct), " (%.1f%%)", (float)value / total * 100);
+        obPuts(ob, pct);
+    }
+    obPutc(ob, '\n');
+}
+
+/* ---------- table：对齐表格 ---------- */
+
+static void tableBegin(OutBuf* ob, MemberView view) {
+    if (view == VIEW_FULL) { renderMemberTableHeader(ob); return; }
+    obSeparator(ob);
+    obTextPad(ob, "卡号", W_CARD);     obPutc(ob, ' ');
+    obTextPad(ob, "姓名", W_NAME);     obPutc(ob, ' ');
+    obTextPad(ob, "类型", W_TYPE);     obPutc(ob, ' ');
+    obTextPad(ob, "状态", W_STATUS);   obPutc(ob, '\n');
+    obSeparator(ob);
+}
+
+static void tableMemberRow(OutBuf* ob, Node* p, MemberView view, long today) {
+    if (view == VIEW_FULL) { renderMemberRowCached(ob, p, today); return; }
+    char num[24];
+    obAsciiPad(ob, num, (size_t)(fmtLong(num, p->data.card_id) - num), W_CARD);  obPutc(ob, ' ');
+    obNameCell(ob, p);                                                          obPutc(ob, ' ');
+    obTextPad(ob, p->data.membership_type, W_TYPE);                             obPutc(ob, ' ');
+    obTextPad(ob, isMemberActive(p, today) ? "有效" : "过期", W_STATUS);          obPutc(ob, '\n');
+}
+
+static void tableEnd(OutBuf* ob, MemberView view) {
+    (void)view;
+    obSeparator(ob);
+}
+
+static void tableReportBegin(OutBuf* ob, const char* title, const char* date) {
+    obPuts(ob, "\n======= ");
+    obPuts(ob, title);
+    obPuts(ob, " =======\n系统当前日期: ");
+    obPuts(ob, date);
+    obPutc(ob, '\n');
+}
+
+/* tableReportSection：分节线，title 非 NULL 时其后输出节标题 */
+static void tableReportSection(OutBuf* ob, const char* title) {
+    obPuts(ob, "---------------------------\n");
+    if (title) textNote(ob, title);
+}
+
+static void tableReportCount(OutBuf* ob, const char* metric, const char* type, const char* label, long value, long total) {
+    (void)metric;
+    textReportCount(ob, type, label, value, total, type ? "  - " : "");
+}
+
+static void tableReportMember(OutBuf* ob, const Node* p, long days_left) {
+    obPuts(ob, "  [警告] 卡号:");  obLong(ob, p->data.card_id);
+    obPuts(ob, " 姓名:");          obPuts(ob, p->data.name);
+    obPuts(ob, " 还有 ");          obLong(ob, days_left);
+    obPuts(ob, " 天到期！\n");
+}
+
+static void tableReportEnd(OutBuf* ob) {
+    obPuts(ob, "=============================\n");
+}
+
+/* ---------- plain：不补齐的纯文本 ---------- */
+
+static void plainBegin(OutBuf* ob, MemberView view) {
+    obPuts(ob, view == VIEW_FULL ? "卡号 | 姓名 | 性别 | 年龄 | 电话 | 入会日期 | 类型 | 状态 | 剩余天数\n"
+                                 : "卡号 | 姓名 | 类型 | 状态\n");
+}
+
+static void plainMemberRow(OutBuf* ob, Node* p, MemberView view, long today) {
+    int active = isMemberActive(p, today);
+    obLong(ob, p->data.card_id);  obPuts(ob, " | ");
+    obPuts(ob, p->data.name);     obPuts(ob, " | ");
+    if (view == VIEW_FULL) {
+        obPuts(ob, p->data.gender);     obPuts(ob, " | ");
+        obLong(ob, p->data.age);        obPuts(ob, " | ");
+        obPuts(ob, p->data.phone);      obPuts(ob, " | ");
+        obPuts(ob, p->data.join_date);  obPuts(ob, " | ");
+    }
+    obPuts(ob, p->data.membership_type);  obPuts(ob, " | ");
+    obPuts(ob, active ? "有效" : "过期");
+    if (view == VIEW_FULL) {
+        obPuts(ob, " | ");
+        if (active) { obLong(ob, calcExpireDays(p) - today); obPuts(ob, " 天"); }
+        else obPuts(ob, "---");
+    }
+    obPutc(ob, '\n');
+}
+
+static void plainEnd(OutBuf* ob, MemberView view) {
+    (void)ob;
+    (void)view;
+}
+
+static void plainReportBegin(OutBuf* ob, const char* title, const char* date) {
+    obPutc(ob, '\n');
+    obPuts(ob, title);
+    obPuts(ob, " (当前日期: ");
+    obPuts(ob, date);
+    obPuts(ob, ")\n");
+}
+
+static void plainReportSection(OutBuf* ob, const char* title) {
+    if (title) textNote(ob, title);
+}
+
+static void plainReportCount(OutBuf* ob, const char* metric, const char* type, const char* label, long value, long total) {
+    (void)metric;
+    textReportCount(ob, type, label, value, total, type ? "  " : "");
+}
+
+static void plainReportMember(OutBuf* ob, const Node* p, long days_left) {
+    obPuts(ob, "  ");
+    obLong(ob, p->data.card_id);  obPuts(ob, " | ");
+    obPuts(ob, p->data.name);     obPuts(ob, " | ");
+    obLong(ob, days_left);        obPuts(ob, " 天\n");
+}
+
+static void plainReportEnd(OutBuf* ob) {
+    (void)ob;
+}
+
+/* ---------- machine：JSON Lines ---------- */
+
+static void machineText(OutBuf* ob, const char* text) {
+    (void)ob;
+    (void)text;
+}
+
+static void machineError(OutBuf* ob, const char* text) {
+    obPuts(ob, "{\"error\":");
+    obJsonString(ob, text);
+    obPuts(ob, "}\n");
+}
+
+static void machineTable(OutBuf* ob, MemberView view) {
+    (void)ob;
+    (void)view;
+}
+
+/* machineMemberRow：简表视图同样输出完整记录，脚本无需区分界面 */
+static void machineMemberRow(OutBuf* ob, Node* p, MemberView view, long today) {
+    (void)view;
+    writeExportRecord(ob, EXPORT_JSONL, p, today);
+}
+
+static void machineMemberDetail(OutBuf* ob, const Node* p, long today) {
+    writeExportRecord(ob, EXPORT_JSONL, p, today);
+}
+
+static void machineReportBegin(OutBuf* ob, const char* title, const char* date) {
+    (void)title;
+    obPuts(ob, "{\"metric\":\"date\",\"value\":");
+    obJsonString(ob, date);
+    obPuts(ob, "}\n");
+}
+
+static void machineReportCount(OutBuf* ob, const char* metric, const char* type, const char* label, long value, long total) {
+    (void)label;
+    (void)total;
+    writeStatRow(ob, EXPORT_JSONL, metric, NULL, type, value);
+}
+
+static void machineReportMember(OutBuf* ob, const Node* p, long days_left) {
+    obPuts(ob, "{\"metric\":\"expiring\",\"card_id\":");  obLong(ob, p->data.card_id);
+    obPuts(ob, ",\"name\":");                             obJsonString(ob, p->data.name);
+    obPuts(ob, ",\"days_left\":");                        obLong(ob, days_left);
+    obPuts(ob, "}\n");
+}
+
+static void machineReportEnd(OutBuf* ob) {
+    (void)ob;
+}
+
+static const OutputBackend output_backends[] = {
+    { "table", textTitle, textNote, textNote, tableBegin, tableMemberRow, tableEnd, textMemberDetail,
+      tableReportBegin, tableReportSection, tableReportCount, tableReportMember, tableReportEnd },
+    { "plain", textTitle, textNote, textNote, plainBegin, plainMemberRow, plainEnd, textMemberDetail,
+      plainReportBegin, plainReportSection, plainReportCount, plainReportMember, plainReportEnd },
+    { "machine", machineText, machineText, machineError, machineTable, machineMemberRow, machineTable, machineMemberDetail,
+      machineReportBegin, machineText, machineReportCount, machineReportMember, machineReportEnd },
+};
+
+/* 当前输出后端（默认表格） */
+static const OutputBackend* output_backend = &output_backends[0];
+
+/* selectOutputBackend：按名称切换输出后端；名称未知返回 0 */
+int selectOutputBackend(const char* name) {
+    for (size_t i = 0; i < sizeof(output_backends) / sizeof(output_backends[0]); i++) {
+        if (strcmp(output_backends[i].name, name) == 0) {
+            output_backend = &output_backends[i];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* outputNote：单独输出一条提示（如“暂无会员信息”），机器可读输出不显示 */
+static void outputNote(const char* text) {
+    OutBuf ob;
+    obInit(&ob, stdout);
+    output_backend->note(&ob, text);
+    obFlush(&ob);
+}
+
+/* outputError：单独输出一条错误信息（机器可读输出同样写出，便于脚本识别失败） */
+static void outputError(const char* text) {
+    OutBuf ob;
+    obInit(&ob, stdout);
+    output_backend->error(&ob, text);
+    obFlush(&ob);
+}
+
+/* 各排序方式的显示名称（下标为 ListOrder） */
+static const char* const list_order_names[LIST_ORDERS] = {
+    "录入顺序", "姓名", "到期日", "入会日期", "类型+到期日"
+};
+
+/*
+ * listMembers：按指定排序方式列表显示全部会员
+ * 关键点：
+ *  - 到期状态按 expire_day 实时判定（只读，不修改结点）
+ *  - 对有效会员计算剩余天数；对过期会员显示 ---
+ *  - 各行经当前输出后端写入输出缓冲区，缓冲区满时整块写出，避免逐字符输出
+ *  - 表格后端中，当天已排版过且未修改的会员直接复用行缓存
+ *  - 非录入顺序时遍历对应的排序排列，排列建立后切换排序方式无需重新排序
+ */
+void listMembers(ListOrder order) {
+    if (member_count == 0) {
+        outputNote("\n暂无会员信息。");
+        return;
+    }
+
+    Node** perm = NULL;
+    if (order != LIST_INSERTION) {
+        perm = sortPermGet(order);
+        if (!perm) { outputError("内存分配失败！"); return; }
+    }
+
+    long current_days = clockToday();
+    const char* current_date_str = clockTodayStr();
+
+    const OutputBackend* out = output_backend;
+    char title[96];
+    snprintf(title, sizeof(title), ">>> 会员列表 (当前日期: %s，按%s)", current_date_str, list_order_names[order]);
+
+    OutBuf ob;
+    obInit(&ob, stdout);
+    out->title(&ob, title);
+    out->tableBegin(&ob, VIEW_FULL);
+
+    if (perm) {
+        for (int i = 0; i < member_count; i++) out->memberRow(&ob, perm[i], VIEW_FULL, current_days);
+    } else {
+        for (Node* p = head; p; p = p->next) out->memberRow(&ob, p, VIEW_FULL, current_days);
+    }
+
+    out->tableEnd(&ob, VIEW_FULL);
+    obFlush(&ob);
+}
+
+/* showAllMembers：选择排序方式后列表显示全部会员 */
+void showAllMembers() {
+    int order;
+    printf("排序方式 (0=录入顺序 1=姓名 2=到期日 3=入会日期 4=类型+到期日): ");
+    if (inputInt(&order) != INPUT_OK) { printf("输入错误！\n"); return; }
+    if (order < LIST_INSERTION || order >= LIST_ORDERS) { printf("无效选项！\n"); return; }
+    listMembers((ListOrder)order);
+}
+
+/*
+ * showMembersPaged：按卡号顺序分页浏览
+ * 关键点：
+ *  - 游标保存“本页首行卡号”，每次翻页通过 card_index 二分定位，增删会员后游标不失效
+ *  - 仅对当前页的会员判定到期状态，渲染成本与页大小相关；整页拼入缓冲区后一次写出
+ *  - 命令：n 下一页、p 上一页、j 卡号 跳转、q 返回
+ */
+void showMembersPaged() {
+    if (member_count == 0) {
+        printf("\n暂无会员信息。\n");
+        return;
+    }
+
+    long current_days = clockToday();
+    const char* current_date_str = clockTodayStr();
+
+    int cursor_id = card_index[0]->data.card_id;
+    char cmd[16];
+
+    while (1) {
+        if (member_count == 0) { printf("\n暂无会员信息。\n"); return; }
+
+        int start = cardIndexLowerBound(cursor_id);
+        if (start >= member_count) start = member_count - PAGE_SIZE > 0 ? member_count - PAGE_SIZE : 0;
+        int end = start + PAGE_SIZE < member_count ? start + PAGE_SIZE : member_count;
+        cursor_id = card_index[start]->data.card_id;
+
+        const OutputBackend* out = output_backend;
+        char title[128];
+        snprintf(title, sizeof(title), ">>> 会员分页浏览 (当前日期: %s)  第 %d-%d 条 / 共 %d 条",
+                 current_date_str, start + 1, end, member_count);
+
+        OutBuf ob;
+        obInit(&ob, stdout);
+        out->title(&ob, title);
+        out->tableBegin(&ob, VIEW_FULL);
+        for (int i = start; i < end; i++) {
+            out->memberRow(&ob, card_index[i], VIEW_FULL, current_days);
+        }
+        out->tableEnd(&ob, VIEW_FULL);
+        obFlush(&ob);
+
+        printf("n=下一页  p=上一页  j=按卡号跳转  q=返回: ");
+        int rc = inputToken(cmd, sizeof(cmd));
+        if (rc == INPUT_EOF) return;
+        if (rc != INPUT_OK) { printf("无效命令！\n"); continue; }
+
+        if (strcmp(cmd, "n") == 0) {
+            if (end < member_count) cursor_id = card_index[end]->data.card_id;
+            else printf("已是最后一页。\n");
+        } else if (strcmp(cmd, "p") == 0) {
+            if (start > 0) cursor_id = card_index[start - PAGE_SIZE > 0 ? start - PAGE_SIZE : 0]->data.card_id;
+            else printf("已是第一页。\n");
+        } else if (strcmp(cmd, "j") == 0) {
+            int id;
+            printf("请输入跳转卡号: ");
+            if (inputInt(&id) != INPUT_OK) { printf("输入错误！\n"); continue; }
+            int pos = cardIndexLowerBound(id);
+            if (pos >= member_count) { printf("没有卡号 >= %d 的会员。\n", id); continue; }
+            if (card_index[pos]->data.card_id != id) printf("卡号 %d 不存在，已定位到其后的第一张卡。\n", id);
+            cursor_id = card_index[pos]->data.card_id;
+        } else if (strcmp(cmd, "q") == 0) {
+            return;
+        } else {
+            printf("无效命令！\n");
+        }
+    }
+}
+
+/*
+ * addMember：新增会员
+ * 输入约束：
+ *  - 性别：仅允许“男/女”
+ *  - 年龄：18~80
+ *  - 电话：11位纯数字
+ * 关键语句说明：
+ *  - 卡号使用 next_card_id 自增生成，保证唯一性
+ *  - 入会日期使用系统日期自动生成
+ *  - 添加完成后立即写回文件，确保数据持久化
+ */
+void addMember() {
+    if (member_count >= MAX_MEMBERS) {
+        printf("会员库已满！\n");
+        return;
+    }
+
+    Member m;
+
+    printf("\n--- 新增会员 (卡号: %d) ---\n", next_card_id);
+
+    while (1) {
+        printf("请输入姓名: ");
+        int rc = inputToken(m.name, sizeof(m.name));
+        if (rc == INPUT_EOF) return;
+        if (rc == INPUT_OK) break;
+        printf("错误：姓名过长（最多 %d 字节）！\n", (int)sizeof(m.name) - 1);
+    }
+
+    while (1) {
+        printf("请输入性别 (男/女): ");
+        int rc = inputToken(m.gender, sizeof(m.gender));
+        if (rc == INPUT_EOF) return;
+        if (rc == INPUT_OK && (strcmp(m.gender, "男") == 0 || strcmp(m.gender, "女") == 0)) break;
+        printf("输入错误！只能输入 '男' 或 '女'。\n");
+    }
+
+    do {
+        printf("请输入年龄 (18-80): ");
+        int rc = inputInt(&m.age);
+        if (rc == INPUT_EOF) return;
+        if (rc != INPUT_OK) {
+            printf("输入非法！\n");
+            m.age = 0;
+            continue;
+        }
+        if (!isValidAge(m.age)) printf("错误：年龄需在18-80之间！\n");
+    } while (!isValidAge(m.age));
+
+    do {
+        printf("请输入电话 (11位手机号): ");
+        if (inputToken(m.phone, sizeof(m.phone)) == INPUT_EOF) return;   /* 超长时为空串，按非法电话提示 */
+        if (!isValidPhone(m.phone)) printf("错误：必须是11位纯数字，请重输！\n");
+    } while (!isValidPhone(m.phone));
+
+    getSystemDate(m.join_date);
+    printf("入会日期: %s (系统自动生成)\n", m.join_date);
+
+    int typeChoice;
+    while (1) {
+        printf("请选择会员类型:\n");
+        printf("  1. 月卡\n  2. 季卡\n  3. 年卡\n");
+        printf("请输入序号 (1-3): ");
+        int rc = inputInt(&typeChoice);
+        if (rc == INPUT_EOF) return;
+        if (rc != INPUT_OK) {
+            printf("请输入数字！\n");
+            continue;
+        }
+        if (typeChoice == 1) { strcpy(m.membership_type, "月卡"); break; }
+        if (typeChoice == 2) { strcpy(m.membership_type, "季卡"); break; }
+        if (typeChoice == 3) { strcpy(m.membership_type, "年卡"); break; }
+        printf("输入错误，请输入 1、2 或 3！\n");
+    }
+
+    m.card_id = next_card_id++;
+    m.is_active = 1;
+
+    Node* node = createNode(&m);
+    if (!node || !appendNode(node)) {
+        freeNode(node);
+        printf("内存分配失败，添加会员失败！\n");
+        return;
+    }
+
+    saveToFile(DATA_FILE);
+    printf(">>> 会员添加成功！(已保存)\n");
+}
+
+/*
+ * updateMemberPhone：修改会员联系方式（电话）
+ * 输入约束：
+ *  - 新电话必须为 11 位纯数字
+ * 关键语句说明：
+ *  - 通过卡号查找结点后只修改 phone 字段，保证其他信息不被误改
+ *  - 修改完成后写回文件
+ */
+void updateMemberPhone() {
+    int id;
+    printf("请输入要修改的会员卡号: ");
+    if (inputInt(&id) != INPUT_OK) { printf("输入错误！\n"); return; }
+
+    Node* p = findByCardID(id);
+    if (!p) { printf("未找到该卡号。\n"); return; }
+
+    printf("当前电话: %s\n", p->data.phone);
+
+    char newPhone[15];
+    do {
+        printf("请输入新电话 (11位手机号): ");
+        if (inputToken(newPhone, sizeof(newPhone)) == INPUT_EOF) return;   /* 超长时为空串，按非法电话提示 */
+        if (!isValidPhone(newPhone)) printf("错误：必须是11位纯数字，请重输！\n");
+    } while (!isValidPhone(newPhone));
+
+    strcpy(p->data.phone, newPhone);
+    invalidateRowCache(p);
+    emitChange(CHANGE_UPDATED, p);
+
+    saveToFile(DATA_FILE);
+    printf("修改成功！(已保存)\n");
+}
+
+/*
+ * removeMember：从链表、卡号索引、排序排列与到期日桶中摘除结点并释放（不做状态校验，交互删除与批处理共用）
+ * 关键点：删除结点时维护 head/tail 指针与 member_count
+ */
+static void removeMember(Node* target) {
+    Node* prev = NULL;
+    Node* cur = head;
+    while (cur && cur != target) {
+        prev = cur;
+        cur = cur->next;
+    }
+    if (!cur) return;
+
+    if (!prev) head = cur->next;
+    else prev->next = cur->next;
+
+    if (cur == tail) tail = prev;
+
+    emitChange(CHANGE_REMOVED, cur);
+    cardIndexRemove(cur->data.card_id);
+    sortPermRemove(cur);
+    bucketUnlink(cur);
+    freeNode(cur);
+    member_count--;
+}
+
+/*
+ * deleteExpiredMember：删除会员（仅限过期/注销）
+ * 关键语句说明：
+ *  - 按今天实时判定状态；仍有效则拒绝删除，防止误删有效会员
+ *  - 删除后写回文件
+ */
+void deleteExpiredMember() {
+    int id;
+    printf("请输入要删除的会员卡号 (必须已过期/已注销): ");
+    if (inputInt(&id) != INPUT_OK) { printf("输入错误！\n"); return; }
+
+    Node* cur = findByCardID(id);
+    if (!cur) { printf("未找到该会员。\n"); return; }
+    if (isMemberActive(cur, clockToday())) { printf("删除失败！会员仍有效。\n"); return; }
+
+    removeMember(cur);
+
+    saveToFile(DATA_FILE);
+    printf("会员已删除。(已保存)\n");
+}
+
+/* parseMemberType：类型文本 -> 标准类型名；接受 月卡/季卡/年卡 或序号 1/2/3，无效返回 NULL */
+static const char* parseMemberType(const char* t) {
+    if (strcmp(t, "1") == 0 || strcmp(t, "月卡") == 0) return "月卡";
+    if (strcmp(t, "2") == 0 || strcmp(t, "季卡") == 0) return "季卡";
+    if (strcmp(t, "3") == 0 || strcmp(t, "年卡") == 0) return "年卡";
+    return NULL;
+}
+
+/*
+ * applyRenewal：续费规则核心（不做输入输出，交互续费与批量续费共用）
+ *  - 过期/注销：从今天重新购买并生效，允许切换类型（更新 join_date，清空 renew_periods/bonus_days）
+ *  - 未到期且同类型：renew_periods 加 1，到期日按入会日起的总月数重算（日期不随月末截断漂移）
+ *  - 未到期且类型不同：拒绝，不修改会员
+ */
+static RenewResult applyRenewal(Node* p, const char* newType, long current_days) {
+    if (p->data.is_active == 0 || calcExpireDays(p) < current_days) {
+        strcpy(p->data.join_date, clockTodayStr());
+        p->renew_periods = 0;
+        p->bonus_days = 0;
+        strcpy(p->data.membership_type, newType);
+        p->data.is_active = 1;
+        updateExpireDay(p);
+        return RENEW_RESTARTED;
+    }
+
+    if (strcmp(newType, p->data.membership_type) != 0) return RENEW_TYPE_MISMATCH;
+
+    p->renew_periods++;
+    p->data.is_active = 1;
+    updateExpireDay(p);
+    return RENEW_EXTENDED;
+}
+
+/*
+ * renewMember：会员续费/延长
+ * 规则设计说明：
+ *  1) 未到期且有效：仅允许同类型续费，通过 renew_periods 累加续费周期，不修改 membership_type
+ *     （避免出现“390天月卡”等类型歧义，保持类型字段语义明确）
+ *  2) 过期/注销：允许选择任意类型，从今天重新生效（更新 join_date，清空 renew_periods/bonus_days）
+ *  3) 续费完成后写回文件
+ */
+void renewMember() {
+    int id;
+    printf("请输入要续费的会员卡号: ");
+    if (inputInt(&id) != INPUT_OK) { printf("输入错误！\n"); return; }
+
+    Node* p = findByCardID(id);
+    if (!p) { reportCardNotFound(id); return; }
+
+    int typeChoice;
+    char newType[10];
+
+    while (1) {
+        printf("请选择续费类型:\n");
+        printf("  1. 月卡(1个月)\n  2. 季卡(3个月)\n  3. 年卡(12个月)\n");
+        printf("请输入序号 (1-3): ");
+        int rc = inputInt(&typeChoice);
+        if (rc == INPUT_EOF) return;
+        if (rc != INPUT_OK) {
+            printf("请输入数字！\n");
+            continue;
+        }
+        if (typeChoice == 1) { strcpy(newType, "月卡"); break; }
+        if (typeChoice == 2) { strcpy(newType, "季卡"); break; }
+        if (typeChoice == 3) { strcpy(newType, "年卡"); break; }
+        printf("输入错误，请输入 1、2 或 3！\n");
+    }
+
+    long current_days = clockToday();
+    long old_expire = calcExpireDays(p);
+    RenewResult r = applyRenewal(p, newType, current_days);
+
+    if (r == RENEW_TYPE_MISMATCH) {
+        printf("续费失败：该会员仍在有效期内，不能更换类型。\n");
+        printf("当前类型：%s。若需更换类型，请等待到期或先手动注销后再购买新类型。\n",
+               p->data.membership_type);
+        return;
+    }
+
+    saveToFile(DATA_FILE);
+    if (r == RENEW_RESTARTED) {
+        printf(">>> 续费成功！已从今天(%s)重新生效，类型：%s (已保存)\n",
+               clockTodayStr(), p->data.membership_type);
+    } else {
+        printf(">>> 续费成功！已延长 %ld 天，类型仍为：%s (已保存)\n",
+               calcExpireDays(p) - old_expire, p->data.membership_type);
+    }
+}
+
+/*
+ * renewFromFile：批量续费
+ * 文件格式：每行 卡号|类型，类型可写 月卡/季卡/年卡 或序号 1/2/3；空行与 # 开头的行忽略
+ * 关键点：
+ *  - 逐行校验并套用与 renewMember 相同的规则（applyRenewal），一遍处理完全部记录
+ *  - 全部处理完后只保存一次
+ *  - 最后输出成功/拒绝汇总，拒绝记录列出行号与原因
+ *  - 超过缓冲区的行整行拒绝并丢弃剩余部分，不会被拆成多行误处理（行号保持准确）
+ */
+void renewFromFile() {
+    char filename[256];
+    printf("请输入批量续费文件名: ");
+    int rc = inputToken(filename, sizeof(filename));
+    if (rc == INPUT_INVALID) printf("文件名过长！\n");
+    if (rc != INPUT_OK) return;
+
+    FILE* fp = fopen(filename, "rb");
+    if (!fp) { printf("无法打开文件 %s\n", filename); return; }
+
+    long current_days = clockToday();
+    char line[256];
+    int line_no = 0, restarted = 0, extended = 0, rejected = 0;
+
+    printf("\n>>> 批量续费 (当前日期: %s)\n", clockTodayStr());
+
+    while (fgets(line, sizeof(line), fp)) {
+        line_no++;
+        size_t len = strlen(line);
+        if (len == sizeof(line) - 1 && line[len - 1] != '\n') {
+            int c = fgetc(fp);
+            if (c != EOF && c != '\n') {
+                while ((c = fgetc(fp)) != '\n' && c != EOF);
+                if (rejected < MAX_BATCH_REJECTS) printf("  [拒绝] 第 %d 行：行过长\n", line_no);
+                rejected++;
+                continue;
+            }
+        }
+        trim_newline(line);
+        if (line[0] == '\0' || line[0] == '#') continue;
+
+        const char* reason = NULL;
+        char* sep = strchr(line, '|');
+        char* end = NULL;
+        errno = 0;
+        long id = strtol(line, &end, 10);
+        const char* newType = NULL;
+
+        if (!sep || end != sep || errno == ERANGE || id <= 0 || id > 0x7FFFFFFF) {
+            reason = "格式错误（应为 卡号|类型）";
+        } else {
+            newType = parseMemberType(sep + 1);
+            if (!newType) reason = "类型无效";
+        }
+
+        Node* p = NULL;
+        if (!reason) {
+            p = findByCardID((int)id);
+            if (!p) reason = cardNotFoundReason((int)id);
+        }
+        RenewResult r = RENEW_TYPE_MISMATCH;
+        if (!reason) {
+            r = applyRenewal(p, newType, current_days);
+            if (r == RENEW_TYPE_MISMATCH) reason = "仍在有效期内，不能更换类型";
+        }
+
+        if (reason) {
+            if (rejected < MAX_BATCH_REJECTS) printf("  [拒绝] 第 %d 行 %s：%s\n", line_no, line, reason);
+            rejected++;
+        } else if (r == RENEW_RESTARTED) {
+            restarted++;
+        } else {
+            extended++;
+        }
+    }
+    fclose(fp);
+
+    if (rejected > MAX_BATCH_REJECTS) printf("  ……其余 %d 条拒绝记录未列出\n", rejected - MAX_BATCH_REJECTS);
+
+    if (restarted + extended > 0) saveToFile(DATA_FILE);
+    printf("---------------------------\n");
+    printf("成功: %d 条（重新生效 %d，同类型延长 %d）  拒绝: %d 条%s\n",
+           restarted + extended, restarted, extended, rejected,
+           restarted + extended > 0 ? " (已保存)" : "");
 }
 
 /*
- * addMember：新增会员
- * 输入约束：
- *  - 性别：仅允许“男/女”
- *  - 年龄：18~80
- *  - 电话：11位纯数字
- * 关键语句说明：
- *  - 卡号使用 next_card_id 自增生成，保证唯一性
- *  - 入会日期使用系统日期自动生成
- *  - 添加完成后立即写回文件，确保数据持久化
+ * searchByCardID：按卡号精确查询
+ * 关键点：
+ *  - 状态按今天实时判定（只读）
+ *  - 有效会员额外输出剩余天数；过期会员显示 ---
+ *  - 详情格式由当前输出后端决定
  */
-void addMember() {
-    if (member_count >= MAX_MEMBERS) {
-        printf("会员库已满！\n");
+void searchByCardID() {
+    int id;
+    printf("请输入查询卡号: ");
+    if (inputInt(&id) != INPUT_OK) { printf("输入错误！\n"); return; }
+
+    Node* p = findByCardID(id);
+    if (!p) { reportCardNotFound(id); return; }
+
+    OutBuf ob;
+    obInit(&ob, stdout);
+    output_backend->title(&ob, ">>> 查询结果:");
+    output_backend->memberDetail(&ob, p, clockToday());
+    obFlush(&ob);
+}
+
+/*
+ * searchByName：按姓名关键字模糊查询
+ * 关键点：
+ *  - 关键字折叠一次后，与各结点预计算的 name_key 做 strstr 子串匹配
+ *    （不区分大小写与全角/半角，逐行无需再折叠）
+ *  - 输出简表，便于管理员快速定位
+ */
+void searchByName() {
+    char key[30];
+    printf("请输入姓名关键字: ");
+    int rc = inputToken(key, sizeof(key));
+    if (rc == INPUT_INVALID) printf("关键字过长！\n");
+    if (rc != INPUT_OK) return;
+
+    char folded_key[30];
+    foldNameKey(key, folded_key, sizeof(folded_key));
+
+    long current_days = clockToday();
+    const OutputBackend* out = output_backend;
+    int found = 0;
+
+    OutBuf ob;
+    obInit(&ob, stdout);
+    out->title(&ob, ">>> 搜索结果:");
+    out->tableBegin(&ob, VIEW_BRIEF);
+
+    for (Node* p = head; p; p = p->next) {
+        if (strstr(p->name_key, folded_key)) {
+            out->memberRow(&ob, p, VIEW_BRIEF, current_days);
+            found = 1;
+        }
+    }
+
+    if (!found) out->note(&ob, "未找到。");
+    out->tableEnd(&ob, VIEW_BRIEF);
+    obFlush(&ob);
+}
+
+/* 表格行输出回调上下文：输出缓冲区 + 今日天数 */
+typedef struct {
+    OutBuf* ob;
+    long today;
+} RowRenderCtx;
+
+/* queryVisitRow：组合查询结果输出回调，ctx 为 RowRenderCtx，经当前输出后端写出 */
+static void queryVisitRow(Node* p, void* ctx) {
+    RowRenderCtx* rc = (RowRenderCtx*)ctx;
+    output_backend->memberRow(rc->ob, p, VIEW_FULL, rc->today);
+}
+
+/*
+ * queryMembers：多条件组合查询
+ * 关键点：
+ *  - 整行读入条件文本，编译为谓词流水线后一次扫描求值
+ *  - 状态按到期日实时判定，不修改会员数据
+ */
+void queryMembers() {
+    long current_days = clockToday();
+    const char* current_date_str = clockTodayStr();
+
+    printf("条件示例: status=active type=年卡 age=20-30 joined>=%.4s-01-01\n", current_date_str);
+    printf("可用字段: card age joined gender type status name~关键字\n");
+    printf("请输入查询条件: ");
+
+    char line[256];
+    if (inputLine(line, sizeof(line)) != INPUT_OK) return;
+
+    Query q;
+    char err[64];
+    if (!compileQuery(line, current_days, &q, err, sizeof(err))) {
+        printf("条件无法识别: %s\n", err);
         return;
     }
 
-    Member m;
-    m.card_id = next_card_id++;
+    const OutputBackend* out = output_backend;
+    OutBuf ob;
+    obInit(&ob, stdout);
+    RowRenderCtx rc = { &ob, current_days };
+    out->title(&ob, ">>> 查询结果:");
+    out->tableBegin(&ob, VIEW_FULL);
+    int matched = runQuery(&q, queryVisitRow, &rc);
+    if (matched == 0) out->note(&ob, "未找到。");
+    out->tableEnd(&ob, VIEW_FULL);
+
+    char summary[32];
+    snprintf(summary, sizeof(summary), "共 %d 条匹配。", matched);
+    out->note(&ob, summary);
+    obFlush(&ob);
+}
+
+/*
+ * updateMemberStatus：手动注销/标记过期（不可逆）
+ * 设计意义：处理“退会/违规停用”等非自然到期场景，与自动到期同步互补
+ * 关键点：
+ *  - 仅修改存储状态 is_active 为 0（已到期会员无需注销）
+ *  - 修改后写回文件
+ */
+void updateMemberStatus() {
+    int id;
+    printf("请输入要注销/标记过期的卡号: ");
+    if (inputInt(&id) != INPUT_OK) { printf("输入错误！\n"); return; }
 
-    printf("\n--- 新增会员 (卡号: %d) ---\n", m.card_id);
+    Node* p = findByCardID(id);
+    if (!p) { printf("未找到该会员。\n"); return; }
 
-    printf("请输入姓名: ");
-    scanf("%29s", m.name);
+    if (!isMemberActive(p, clockToday())) {
+        printf("该会员已是过期/注销状态。\n");
+        return;
+    }
 
-    while (1) {
-        printf("请输入性别 (男/女): ");
-        scanf("%9s", m.gender);
-        if (strcmp(m.gender, "男") == 0 || strcmp(m.gender, "女") == 0) break;
-        printf("输入错误！只能输入 '男' 或 '女'。\n");
+    p->data.is_active = 0;
+    refreshExpiryIndexes(p);
+
+    saveToFile(DATA_FILE);
+    printf("会员 %s 已注销/标记为过期。(已保存)\n", p->data.name);
+}
+
+/* printReminderWarning：到期提醒输出回调 */
+static void printReminderWarning(Node* p, long days_left, void* ctx) {
+    (void)ctx;
+    printf("  [警告] 卡号:%d 姓名:%s 还有 %ld 天到期！\n", p->data.card_id, p->data.name, days_left);
+}
+
+/* writeReminderLine：到期提醒导出回调，逐行写入 ctx 指向的输出缓冲：卡号|姓名|电话|类型|到期日|剩余天数 */
+static void writeReminderLine(Node* p, long days_left, void* ctx) {
+    OutBuf* ob = (OutBuf*)ctx;
+    char date[12];
+    daysToDate(p->expire_day, date);
+    obLong(ob, p->data.card_id);          obPutc(ob, '|');
+    obPuts(ob, p->data.name);             obPutc(ob, '|');
+    obPuts(ob, p->data.phone);            obPutc(ob, '|');
+    obPuts(ob, p->data.membership_type);  obPutc(ob, '|');
+    obWrite(ob, date, 10);                obPutc(ob, '|');
+    obLong(ob, days_left);                obPutc(ob, '\n');
+}
+
+/*
+ * showRenewalReminders：按窗口显示续费提醒，并可导出
+ * 关键点：
+ *  - 窗口天数 1~365（常用 7/30/90），只访问窗口内的日桶
+ *  - 导出时边遍历边写文件，不在内存中汇总结果
+ */
+void showRenewalReminders() {
+    int window;
+    printf("请输入提醒窗口天数 (如 7/30/90，最大 %d): ", EXPIRY_RING_DAYS - 1);
+    if (inputInt(&window) != INPUT_OK) { printf("输入错误！\n"); return; }
+    if (window < 1 || window >= EXPIRY_RING_DAYS) { printf("窗口天数需在 1-%d 之间！\n", EXPIRY_RING_DAYS - 1); return; }
+
+    long current_days = clockToday();
+
+    printf("\n>>> %d 天内到期会员 (当前日期: %s):\n", window, clockTodayStr());
+    int count = forEachExpiring(current_days, window, printReminderWarning, NULL);
+    if (count == 0) { printf("  暂无即将到期的会员。\n"); return; }
+    printf("共 %d 人。\n", count);
+
+    int doExport;
+    printf("是否导出到 %s？(1=是 0=否): ", REMINDER_FILE);
+    if (inputInt(&doExport) != INPUT_OK) return;
+    if (doExport != 1) return;
+
+    FILE* fp = fopen(REMINDER_FILE, "wb");
+    if (!fp) { printf("导出失败：无法写入 %s\n", REMINDER_FILE); return; }
+    OutBuf ob;
+    obInit(&ob, fp);
+    forEachExpiring(current_days, window, writeReminderLine, &ob);
+    int ok = obFlush(&ob);
+    if (fclose(fp) != 0 || !ok) { printf("导出失败：写入 %s 出错\n", REMINDER_FILE); return; }
+    printf("已导出 %d 条提醒到 %s。\n", count, REMINDER_FILE);
+}
+
+/* printHistogramRows：输出一组分布行（跳过空行），width 为每组天数 */
+static void printHistogramRows(const char* title, int (*rows)[MEMBER_TYPES], int n, int width, int max_total) {
+    printf("%s\n", title);
+    printf("  剩余天数        月卡    季卡    年卡    合计\n");
+    for (int i = 0; i < n; i++) {
+        int total = rows[i][0] + rows[i][1] + rows[i][2];
+        if (total == 0) continue;
+
+        int lo = i * width, hi = i * width + width - 1;
+        if (hi > EXPIRY_RING_DAYS - 1) hi = EXPIRY_RING_DAYS - 1;
+        printf("  %3d-%3d 天   %7d %7d %7d %7d  ", lo, hi, rows[i][0], rows[i][1], rows[i][2], total);
+        int bar = max_total > 0 ? (int)((long)total * 30 / max_total) : 0;
+        for (int k = 0; k < (bar > 0 ? bar : 1); k++) putchar('#');
+        putchar('\n');
     }
+}
 
-    do {
-        printf("请输入年龄 (18-80): ");
-        if (scanf("%d", &m.age) != 1) {
-            printf("输入非法！\n");
-            clearInputBuffer();
-            m.age = 0;
-            continue;
+/*
+ * showExpiryHistogram：剩余天数分布报表（按周、按 30 天分组，分类型计数）
+ * 关键点：
+ *  - 先执行调度器心跳，保证桶环基准日为今天
+ *  - 分布由日桶计数增量生成，只读 366 个槽位，耗时与会员总数无关
+ */
+void showExpiryHistogram() {
+    schedulerTick();
+    long current_days = clockToday();
+
+    ExpiryHistogram h;
+    buildHistogramIncremental(current_days, &h);
+
+    int active = h.beyond[0] + h.beyond[1] + h.beyond[2];
+    int max_week = 0, max_month = 0;
+    for (int i = 0; i < HIST_WEEKS; i++) {
+        int total = h.week[i][0] + h.week[i][1] + h.week[i][2];
+        active += total;
+        if (total > max_week) max_week = total;
+    }
+    for (int i = 0; i < HIST_MONTHS; i++) {
+        int total = h.month[i][0] + h.month[i][1] + h.month[i][2];
+        if (total > max_month) max_month = total;
+    }
+
+    printf("\n======= 剩余天数分布 =======\n");
+    printf("系统当前日期: %s    有效会员: %d 人\n", clockTodayStr(), active);
+    if (active == 0) { printf("暂无有效会员。\n"); return; }
+
+    printf("---------------------------\n");
+    printHistogramRows(">>> 按周:", h.week, HIST_WEEKS, 7, max_week);
+    printf("---------------------------\n");
+    printHistogramRows(">>> 按月 (30天):", h.month, HIST_MONTHS, 30, max_month);
+    printf("---------------------------\n");
+    printf("超过 %d 天: 月卡 %d  季卡 %d  年卡 %d\n", EXPIRY_RING_DAYS - 1, h.beyond[0], h.beyond[1], h.beyond[2]);
+    printf("=============================\n");
+}
+
+/*
+ * countActiveByType：统计有效会员总数及各类型人数（by_type 按 memberTypeIndex 下标）
+ * 关键点：到期日列经 SIMD 批量判定生成有效位图，只对置位的会员读取类型
+ * 返回值：有效会员总数；内存不足返回 -1
+ */
+static int countActiveByType(long today, int by_type[MEMBER_TYPES]) {
+    memset(by_type, 0, MEMBER_TYPES * sizeof(int));
+    if (member_count == 0) return 0;
+
+    size_t words = ((size_t)member_count + 63) / 64;
+    uint64_t* active_bits = (uint64_t*)malloc(words * sizeof(uint64_t));
+    if (!active_bits) return -1;
+    int active_count = (int)bulkEvalActive(expire_col, (size_t)member_count, (int32_t)today, active_bits);
+
+    for (size_t w = 0; w < words; w++) {
+        for (uint64_t bits = active_bits[w]; bits; bits &= bits - 1) {
+            const Node* p = card_index[w * 64 + (size_t)ctz64(bits)];
+            int t = memberTypeIndex(p->data.membership_type);
+            if (t >= 0) by_type[t]++;
         }
-        if (!isValidAge(m.age)) printf("错误：年龄需在18-80之间！\n");
-    } while (!isValidAge(m.age));
+    }
 
-    do {
-        printf("请输入电话 (11位手机号): ");
-        scanf("%14s", m.phone);
-        if (!isValidPhone(m.phone)) printf("错误：必须是11位纯数字，请重输！\n");
-    } while (!isValidPhone(m.phone));
+    free(active_bits);
+    return active_count;
+}
 
-    getSystemDate(m.join_date);
-    printf("入会日期: %s (系统自动生成)\n", m.join_date);
+/* reportMemberVisit：到期提醒回调，ctx 为输出缓冲区，经当前输出后端写出 */
+static void reportMemberVisit(Node* p, long days_left, void* ctx) {
+    output_backend->reportMember((OutBuf*)ctx, p, days_left);
+}
 
-    int typeChoice;
-    while (1) {
-        printf("请选择会员类型:\n");
-        printf("  1. 月卡\n  2. 季卡\n  3. 年卡\n");
-        printf("请输入序号 (1-3): ");
-        if (scanf("%d", &typeChoice) != 1) {
-            printf("请输入数字！\n");
-            clearInputBuffer();
-            continue;
+/*
+ * showStatistics：统计分析
+ * 输出内容：
+ *  - 有效会员总数（到期日列经 bulkEvalActive 批量判定，同时得到有效位图）
+ *  - 月卡/季卡/年卡数量与占比（只遍历位图中的有效会员）
+ *  - 30天内到期提醒（取到期日桶中 31 个日桶，按剩余天数升序）
+ * 报表格式由当前输出后端决定
+ */
+void showStatistics() {
+    static const char* types[MEMBER_TYPES] = {"月卡", "季卡", "年卡"};
+    if (member_count == 0) { outputNote("暂无数据。"); return; }
+
+    long current_days = clockToday();
+    const char* current_date_str = clockTodayStr();
+
+    int by_type[MEMBER_TYPES];
+    int active_count = countActiveByType(current_days, by_type);
+    if (active_count < 0) { outputError("内存分配失败！"); return; }
+
+    const OutputBackend* out = output_backend;
+    OutBuf ob;
+    obInit(&ob, stdout);
+    out->reportBegin(&ob, "统计分析报表", current_date_str);
+
+    out->reportSection(&ob, NULL);
+    out->reportCount(&ob, "active", NULL, "有效会员总数", active_count, active_count);
+    if (active_count > 0) {
+        for (int t = 0; t < MEMBER_TYPES; t++) {
+            out->reportCount(&ob, "active", types[t], types[t], by_type[t], active_count);
         }
-        if (typeChoice == 1) { strcpy(m.membership_type, "月卡"); break; }
-        if (typeChoice == 2) { strcpy(m.membership_type, "季卡"); break; }
-        if (typeChoice == 3) { strcpy(m.membership_type, "年卡"); break; }
-        printf("输入错误，请输入 1、2 或 3！\n");
     }
 
-    m.is_active = 1;
+    out->reportSection(&ob, ">>> 即将到期会员提示 (30天内):");
 
-    Node* node = createNode(&m);
-    if (!node) {
-        printf("内存分配失败，添加会员失败！\n");
+    int warning_count = forEachExpiring(current_days, 30, reportMemberVisit, &ob);
+
+    if (warning_count == 0) out->note(&ob, "  暂无即将到期的会员。");
+    out->reportEnd(&ob);
+    obFlush(&ob);
+}
+
+/* =========================================================
+ *  实时统计看板：有效人数、类型构成与即将到期清单
+ *  说明：
+ *   - 开启时统计一次，之后由会员变更通知逐条增量维护各类型有效人数与窗口内到期人数（每条 O(1)）
+ *   - 只有变更可能影响到期清单时（会员在上次显示的清单中，或变更后落入窗口）才重取清单，
+ *     重取按日桶顺序取满 DASH_LIST_MAX 名即停
+ *   - 菜单循环每次交互前刷新：只输出与上次显示不同的数值和清单条目；
+ *     跨日后剩余天数整体变化，重新统计并整屏输出
+ * ========================================================= */
+
+/* dashboardCount：回退结点原先的计数，再按模型日期重新计入（counted 为 0 时只回退） */
+static void dashboardCount(Node* p, int counted) {
+    if (p->dash_type >= 0) dashboard.active[p->dash_type]--;
+    if (p->dash_window) dashboard.expiring--;
+    p->dash_type = -1;
+    p->dash_window = 0;
+    if (!counted || !isMemberActive(p, dashboard.day)) return;
+    if (p->expire_day - dashboard.day <= DASH_WINDOW) {
+        p->dash_window = 1;
+        dashboard.expiring++;
+    }
+    int t = memberTypeIndex(p->data.membership_type);
+    if (t < 0) return;
+    p->dash_type = (signed char)t;
+    dashboard.active[t]++;
+}
+
+/* dashboardRebuild：按 today 重新统计全部会员（开启看板、跨日或会员被整体释放后） */
+static void dashboardRebuild(long today) {
+    dashboard.day = today;
+    memset(dashboard.active, 0, sizeof(dashboard.active));
+    dashboard.expiring = 0;
+    for (Node* p = head; p; p = p->next) {
+        p->dash_type = -1;
+        p->dash_window = 0;
+        dashboardCount(p, 1);
+    }
+    dashboard.dirty = 1;
+    dashboard.list_dirty = 1;
+}
+
+/* dashboardShownIndex：卡号在上次显示的清单中的位置，不在清单中返回 -1 */
+static int dashboardShownIndex(int card_id) {
+    for (int i = 0; i < dashboard.shown_count; i++) {
+        if (dashboard.shown[i].card_id == card_id) return i;
+    }
+    return -1;
+}
+
+/* dashboardOnChange：变更通知回调，更新计数并标记待刷新 */
+static void dashboardOnChange(ChangeKind kind, Node* p, void* ctx) {
+    (void)ctx;
+    if (!dashboard.enabled) return;
+    if (kind == CHANGE_CLEARED) {
+        dashboard.day = 0;      /* 下次刷新时整体重建 */
         return;
     }
-    appendNode(node);
+    dashboardCount(p, kind != CHANGE_REMOVED);
+    dashboard.dirty = 1;
+    if (p->dash_window || dashboardShownIndex(p->data.card_id) >= 0) dashboard.list_dirty = 1;
+}
 
-    saveToFile(DATA_FILE);
-    printf(">>> 会员添加成功！(已保存)\n");
+/*
+ * dashboardCollect：按剩余天数升序取窗口内最先到期的至多 DASH_LIST_MAX 名会员
+ * 说明：与 forEachExpiring 的访问顺序一致，但取满即停，窗口内会员很多时也只访问少量结点
+ */
+static int dashboardCollect(DashEntry* list) {
+    int count = 0;
+    for (long d = dashboard.day; d <= dashboard.day + DASH_WINDOW && count < DASH_LIST_MAX; d++) {
+        for (Node* p = expiry_buckets[d % EXPIRY_RING_DAYS]; p && count < DASH_LIST_MAX; p = p->bucket_next) {
+            if (p->expire_day != d || p->data.is_active != 1) continue;
+            DashEntry* e = &list[count++];
+            e->card_id = p->data.card_id;
+            e->days_left = d - dashboard.day;
+            strcpy(e->name, p->data.name);
+        }
+    }
+    return count;
+}
+
+/* obDashEntry：写入一条清单条目：前缀 卡号:… 姓名:… */
+static void obDashEntry(OutBuf* ob, const char* prefix, const DashEntry* e) {
+    obPuts(ob, prefix);
+    obPuts(ob, "卡号:");   obLong(ob, e->card_id);
+    obPuts(ob, " 姓名:");  obPuts(ob, e->name);
+}
+
+/* obDashChange：写入一个变化的数值：  标签: 旧 → 新 */
+static void obDashChange(OutBuf* ob, const char* label, long before, long after, const char* unit) {
+    obPuts(ob, "  ");
+    obPuts(ob, label);
+    obPuts(ob, ": ");
+    obLong(ob, before);
+    obPuts(ob, " → ");
+    obLong(ob, after);
+    obPuts(ob, unit);
+    obPutc(ob, '\n');
+}
+
+/* dashboardListChanged：新清单与上次显示的清单是否不同（条目或剩余天数） */
+static int dashboardListChanged(const DashEntry* list, int count) {
+    if (count != dashboard.shown_count) return 1;
+    for (int i = 0; i < count; i++) {
+        int k = dashboardShownIndex(list[i].card_id);
+        if (k < 0 || dashboard.shown[k].days_left != list[i].days_left) return 1;
+    }
+    return 0;
 }
 
 /*
- * updateMemberPhone：修改会员联系方式（电话）
- * 输入约束：
- *  - 新电话必须为 11 位纯数字
- * 关键语句说明：
- *  - 通过卡号查找结点后只修改 phone 字段，保证其他信息不被误改
- *  - 修改完成后写回文件
+ * dashboardRefresh：输出看板并记录本次显示的内容
+ *  - full 为 1 时整屏输出（开启、跨日）
+ *  - 否则只输出变化项：人数“旧 → 新”，清单中新增（+）、移出（-）、剩余天数变化（~）的会员
  */
-void updateMemberPhone() {
-    int id;
-    printf("请输入要修改的会员卡号: ");
-    if (scanf("%d", &id) != 1) { printf("输入错误！\n"); clearInputBuffer(); return; }
+static void dashboardRefresh(int full) {
+    static const char* types[MEMBER_TYPES] = {"月卡", "季卡", "年卡"};
+
+    DashEntry list[DASH_LIST_MAX];
+    int count = dashboard.shown_count;
+    int expiring = dashboard.expiring;
+    if (full || dashboard.list_dirty) {
+        count = dashboardCollect(list);
+    } else {
+        memcpy(list, dashboard.shown, (size_t)count * sizeof(DashEntry));
+    }
 
-    Node* p = findByCardID(id);
-    if (!p) { printf("未找到该卡号。\n"); return; }
+    int total = 0, shown_total = 0;
+    for (int t = 0; t < MEMBER_TYPES; t++) {
+        total += dashboard.active[t];
+        shown_total += dashboard.shown_active[t];
+    }
 
-    printf("当前电话: %s\n", p->data.phone);
+    OutBuf ob;
+    obInit(&ob, stdout);
+    if (full) {
+        char date[12];
+        daysToDate(dashboard.day, date);
+        obPuts(&ob, "\n======= 实时统计看板 (");
+        obPuts(&ob, date);
+        obPuts(&ob, ") =======\n");
+        textReportCount(&ob, NULL, "有效会员总数", total, total, "");
+        for (int t = 0; t < MEMBER_TYPES; t++) {
+            textReportCount(&ob, types[t], types[t], dashboard.active[t], total, "  - ");
+        }
+        obLong(&ob, DASH_WINDOW);
+        obPuts(&ob, " 天内到期: ");
+        obLong(&ob, expiring);
+        obPuts(&ob, " 人\n");
+        for (int i = 0; i < count; i++) {
+            obDashEntry(&ob, "  [警告] ", &list[i]);
+            obPuts(&ob, " 还有 ");
+            obLong(&ob, list[i].days_left);
+            obPuts(&ob, " 天到期！\n");
+        }
+        if (expiring > count) {
+            obPuts(&ob, "  …… 另有 ");
+            obLong(&ob, expiring - count);
+            obPuts(&ob, " 人\n");
+        }
+        obPuts(&ob, "=============================\n");
+    } else if (total != shown_total || expiring != dashboard.shown_expiring ||
+               memcmp(dashboard.active, dashboard.shown_active, sizeof(dashboard.active)) != 0 ||
+               dashboardListChanged(list, count)) {
+        obPuts(&ob, "\n[看板] 统计变化:\n");
+        if (total != shown_total) obDashChange(&ob, "有效会员总数", shown_total, total, " 人");
+        for (int t = 0; t < MEMBER_TYPES; t++) {
+            if (dashboard.active[t] != dashboard.shown_active[t]) {
+                obDashChange(&ob, types[t], dashboard.shown_active[t], dashboard.active[t], "");
+            }
+        }
+        if (expiring != dashboard.shown_expiring) {
+            char label[32];
+            snprintf(label, sizeof(label), "%d 天内到期", DASH_WINDOW);
+            obDashChange(&ob, label, dashboard.shown_expiring, expiring, " 人");
+        }
+        for (int i = 0; i < count; i++) {
+            int k = dashboardShownIndex(list[i].card_id);
+            if (k < 0) {
+                obDashEntry(&ob, "  + ", &list[i]);
+                obPuts(&ob, " 还有 ");
+                obLong(&ob, list[i].days_left);
+                obPuts(&ob, " 天\n");
+            } else if (dashboard.shown[k].days_left != list[i].days_left) {
+                obDashEntry(&ob, "  ~ ", &list[i]);
+                obPuts(&ob, " 还有 ");
+                obLong(&ob, dashboard.shown[k].days_left);
+                obPuts(&ob, " → ");
+                obLong(&ob, list[i].days_left);
+                obPuts(&ob, " 天\n");
+            }
+        }
+        for (int k = 0; k < dashboard.shown_count; k++) {
+            int found = 0;
+            for (int i = 0; i < count && !found; i++) found = list[i].card_id == dashboard.shown[k].card_id;
+            if (!found) {
+                obDashEntry(&ob, "  - ", &dashboard.shown[k]);
+                obPutc(&ob, '\n');
+            }
+        }
+    }
+    obFlush(&ob);
+
+    memcpy(dashboard.shown_active, dashboard.active, sizeof(dashboard.active));
+    memcpy(dashboard.shown, list, (size_t)count * sizeof(DashEntry));
+    dashboard.shown_count = count;
+    dashboard.shown_expiring = expiring;
+    dashboard.dirty = 0;
+    dashboard.list_dirty = 0;
+}
 
-    char newPhone[15];
-    do {
-        printf("请输入新电话 (11位手机号): ");
-        scanf("%14s", newPhone);
-        if (!isValidPhone(newPhone)) printf("错误：必须是11位纯数字，请重输！\n");
-    } while (!isValidPhone(newPhone));
+/* dashboardTick：看板刷新；未开启或无变更时只做几次比较 */
+void dashboardTick() {
+    if (!dashboard.enabled) return;
+    long today = clockToday();
+    if (today != dashboard.day) {
+        dashboardRebuild(today);
+        dashboardRefresh(1);
+        return;
+    }
+    if (dashboard.dirty) dashboardRefresh(0);
+}
 
-    strcpy(p->data.phone, newPhone);
+/* toggleDashboard：开启/关闭实时统计看板；首次开启时订阅变更通知 */
+void toggleDashboard() {
+    if (dashboard.enabled) {
+        dashboard.enabled = 0;
+        printf("实时统计看板已关闭。\n");
+        return;
+    }
+    if (!dashboard.subscribed) {
+        if (!changeSubscribe(dashboardOnChange, NULL)) { printf("变更通知订阅者已满，无法开启看板！\n"); return; }
+        dashboard.subscribed = 1;
+    }
+    dashboard.enabled = 1;
+    printf("实时统计看板已开启：此后每次操作只显示发生变化的统计项。\n");
+    dashboardRebuild(clockToday());
+    dashboardRefresh(1);
+}
 
-    saveToFile(DATA_FILE);
-    printf("修改成功！(已保存)\n");
+/*
+ * showSoonestExpiring：按剩余天数升序列出最近到期的前 K 名有效会员
+ * 关键点：K 默认为 DEFAULT_TOP_K；使用有界堆，不对全体会员排序
+ */
+void showSoonestExpiring() {
+    int k;
+    printf("请输入显示人数 (默认 %d，输入 0 使用默认值): ", DEFAULT_TOP_K);
+    if (inputInt(&k) != INPUT_OK) { printf("输入错误！\n"); return; }
+    if (k <= 0) k = DEFAULT_TOP_K;
+    if (k > member_count) k = member_count;
+    if (k == 0) { printf("暂无数据。\n"); return; }
+
+    ExpiryEntry* top = (ExpiryEntry*)malloc((size_t)k * sizeof(ExpiryEntry));
+    if (!top) { printf("内存分配失败！\n"); return; }
+
+    int n = topKExpiring(clockToday(), k, top);
+    const char* current_date_str = clockTodayStr();
+
+    printf("\n>>> 最近到期的 %d 名有效会员 (当前日期: %s)\n", n, current_date_str);
+    printSeparator();
+    for (int i = 0; i < n; i++) {
+        printf("  %3d. 卡号:%d 姓名:%s 类型:%s 还有 %ld 天到期\n", i + 1,
+               top[i].node->data.card_id, top[i].node->data.name,
+               top[i].node->data.membership_type, top[i].days_left);
+    }
+    if (n == 0) printf("  暂无有效会员。\n");
+    printSeparator();
+
+    free(top);
 }
 
 /*
- * deleteExpiredMember：删除会员（仅限过期/注销）
- * 关键语句说明：
- *  - 删除前先 syncAutoExpire，避免状态过时
- *  - 若 is_active==1，则拒绝删除，防止误删有效会员
- *  - 删除结点时维护 head/tail 指针与 member_count
- *  - 删除后写回文件
+ * exportData：导出会员列表、组合查询结果或统计报表
+ * 关键点：
+ *  - 格式可选 CSV（Excel 等表格软件）或 JSON Lines（脚本逐行处理）
+ *  - 边遍历边写入定长输出缓冲后落盘，不在内存中汇总导出内容
+ */
+void exportData() {
+    int scope, format;
+    printf("\n------- 数据导出 -------\n");
+    printf("1. 全部会员\n");
+    printf("2. 组合查询结果\n");
+    printf("3. 统计报表\n");
+    printf("请选择导出内容 (1-3): ");
+    if (inputInt(&scope) != INPUT_OK) { printf("输入错误！\n"); return; }
+    if (scope < 1 || scope > 3) { printf("无效选项！\n"); return; }
+
+    printf("请选择格式 (1=CSV 2=JSON Lines): ");
+    if (inputInt(&format) != INPUT_OK) { printf("输入错误！\n"); return; }
+    if (format != 1 && format != 2) { printf("无效选项！\n"); return; }
+    ExportFormat fmt = format == 1 ? EXPORT_CSV : EXPORT_JSONL;
+
+    long current_days = clockToday();
+    Query q;
+    if (scope == 2) {
+        printf("可用字段: card age joined gender type status name~关键字\n");
+        printf("请输入查询条件: ");
+        char line[256];
+        if (inputLine(line, sizeof(line)) != INPUT_OK) return;
+
+        char err[64];
+        if (!compileQuery(line, current_days, &q, err, sizeof(err))) {
+            printf("条件无法识别: %s\n", err);
+            return;
+        }
+    }
+
+    const char* default_file = fmt == EXPORT_CSV ? EXPORT_CSV_FILE : EXPORT_JSONL_FILE;
+    char filename[256];
+    printf("请输入导出文件名 (输入 - 使用默认 %s): ", default_file);
+    int rc = inputToken(filename, sizeof(filename));
+    if (rc == INPUT_INVALID) printf("文件名过长！\n");
+    if (rc != INPUT_OK) return;
+    if (strcmp(filename, "-") == 0) strcpy(filename, default_file);
+
+    FILE* fp = fopen(filename, "wb");
+    if (!fp) { printf("导出失败：无法写入 %s\n", filename); return; }
+
+    long rows = scope == 3 ? exportStatistics(fp, fmt, current_days)
+                           : exportMembers(fp, fmt, scope == 2 ? &q : NULL, current_days);
+    if (fclose(fp) != 0 || rows < 0) { printf("导出失败：写入 %s 出错\n", filename); return; }
+    printf("已导出 %ld 条记录到 %s。\n", rows, filename);
+}
+
+/* =========================================================
+ *  批处理命令模式：gym --batch <文件|->
+ *  输入：JSON Lines，每行一个操作对象，如
+ *    {"op":"add","name":"张三","gender":"男","age":25,"phone":"13800000000","type":"年卡"}
+ *    {"op":"renew","card_id":1001,"type":"季卡"}
+ *  支持的 op：add / phone / renew / cancel / delete / get / query / checkpoint
+ *  输出：每个操作一行 JSON 结果，{"line":行号,"ok":true,...} 或 {"line":行号,"ok":false,"error":"原因"}
+ *  规则与交互菜单一致（applyRenewal、有效会员不可删除等），不输出任何提示
+ *  保存：修改先只作用于内存，遇到 checkpoint 或批处理结束时才写回文件
+ * ========================================================= */
+
+/* 扁平 JSON 对象的一个键值对：字符串值已反转义；数字/true/false/null 保存原文 */
+typedef struct {
+    char key[16];
+    char value[BATCH_VALUE_MAX];
+    int is_string;
+} JsonField;
+
+/* jsonSkipSpace：跳过 JSON 空白 */
+static const char* jsonSkipSpace(const char* s) {
+    while (*s == ' ' || *s == '\t' || *s == '\r' || *s == '\n') s++;
+    return s;
+}
+
+/* jsonHex4：读取 4 位十六进制数，失败返回 -1 */
+static long jsonHex4(const char* s) {
+    long v = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = s[i];
+        int d = (c >= '0' && c <= '9') ? c - '0' :
+                (c >= 'a' && c <= 'f') ? c - 'a' + 10 :
+                (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+        if (d < 0) return -1;
+        v = v * 16 + d;
+    }
+    return v;
+}
+
+/*
+ * jsonParseString：解析以 " 开头的 JSON 字符串到 out（UTF-8），返回结束引号之后的位置，失败返回 NULL
+ * 说明：支持 \" \\ \/ \b \f \n \r \t 与 \uXXXX（含代理对）；超出 out 容量视为失败
+ */
+static const char* jsonParseString(const char* s, char* out, size_t out_size) {
+    size_t o = 0;
+    for (s++; *s != '"'; s++) {
+        if (*s == '\0' || (unsigned char)*s < 0x20) return NULL;
+        uint32_t u = (unsigned char)*s;
+        int raw = 1;
+        if (*s == '\\') {
+            raw = 0;
+            s++;
+            switch (*s) {
+                case '"': case '\\': case '/': u = (unsigned char)*s; break;
+                case 'b': u = '\b'; break;
+                case 'f': u = '\f'; break;
+                case 'n': u = '\n'; break;
+                case 'r': u = '\r'; break;
+                case 't': u = '\t'; break;
+                case 'u': {
+                    long hi = jsonHex4(s + 1);
+                    if (hi < 0) return NULL;
+                    s += 4;
+                    u = (uint32_t)hi;
+                    if (hi >= 0xD800 && hi <= 0xDBFF) {
+                        long lo = (s[1] == '\\' && s[2] == 'u') ? jsonHex4(s + 3) : -1;
+                        if (lo < 0xDC00 || lo > 0xDFFF) return NULL;
+                        s += 6;
+                        u = 0x10000 + (((uint32_t)hi - 0xD800) << 10) + ((uint32_t)lo - 0xDC00);
+                    } else if (hi >= 0xDC00 && hi <= 0xDFFF) {
+                        return NULL;
+                    }
+                    break;
+                }
+                default: return NULL;
+            }
+        }
+
+        char enc[4];
+        int n;
+        if (raw || u < 0x80) { enc[0] = (char)u; n = 1; }
+        else if (u < 0x800) { enc[0] = (char)(0xC0 | (u >> 6)); enc[1] = (char)(0x80 | (u & 0x3F)); n = 2; }
+        else if (u < 0x10000) {
+            enc[0] = (char)(0xE0 | (u >> 12)); enc[1] = (char)(0x80 | ((u >> 6) & 0x3F));
+            enc[2] = (char)(0x80 | (u & 0x3F)); n = 3;
+        } else {
+            enc[0] = (char)(0xF0 | (u >> 18)); enc[1] = (char)(0x80 | ((u >> 12) & 0x3F));
+            enc[2] = (char)(0x80 | ((u >> 6) & 0x3F)); enc[3] = (char)(0x80 | (u & 0x3F)); n = 4;
+        }
+        if (o + (size_t)n >= out_size) return NULL;
+        memcpy(out + o, enc, (size_t)n);
+        o += (size_t)n;
+    }
+    out[o] = '\0';
+    return s + 1;
+}
+
+/*
+ * parseJsonObject：解析一行扁平 JSON 对象（值只能是字符串、数字、true/false/null）
+ * 返回值：键值对数量；格式错误返回 -1
  */
-void deleteExpiredMember() {
-    syncAutoExpire();
+static int parseJsonObject(const char* line, JsonField* fields, int max_fields) {
+    const char* s = jsonSkipSpace(line);
+    if (*s++ != '{') return -1;
+
+    int n = 0;
+    s = jsonSkipSpace(s);
+    if (*s == '}') return *jsonSkipSpace(s + 1) ? -1 : 0;
+
+    for (;;) {
+        if (n >= max_fields || *s != '"') return -1;
+        JsonField* f = &fields[n++];
+        s = jsonParseString(s, f->key, sizeof(f->key));
+        if (!s) return -1;
+        s = jsonSkipSpace(s);
+        if (*s++ != ':') return -1;
+        s = jsonSkipSpace(s);
+
+        if (*s == '"') {
+            s = jsonParseString(s, f->value, sizeof(f->value));
+            if (!s) return -1;
+            f->is_string = 1;
+        } else {
+            size_t len = strcspn(s, ",} \t\r\n");
+            if (len == 0 || len >= sizeof(f->value)) return -1;
+            memcpy(f->value, s, len);
+            f->value[len] = '\0';
+            f->is_string = 0;
+            s += len;
+        }
 
-    int id;
-    printf("请输入要删除的会员卡号 (必须已过期/已注销): ");
-    if (scanf("%d", &id) != 1) { printf("输入错误！\n"); clearInputBuffer(); return; }
+        s = jsonSkipSpace(s);
+        if (*s == ',') { s = jsonSkipSpace(s + 1); continue; }
+        if (*s == '}') return *jsonSkipSpace(s + 1) ? -1 : n;
+        return -1;
+    }
+}
 
-    Node* prev = NULL;
-    Node* cur = head;
-    while (cur) {
-        if (cur->data.card_id == id) break;
-        prev = cur;
-        cur = cur->next;
+/* jsonGet：按键名查找值，不存在返回 NULL */
+static const char* jsonGet(const JsonField* fields, int n, const char* key) {
+    for (int i = 0; i < n; i++) {
+        if (strcmp(fields[i].key, key) == 0) return fields[i].value;
     }
+    return NULL;
+}
 
-    if (!cur) { printf("未找到该会员。\n"); return; }
-    if (cur->data.is_active == 1) { printf("删除失败！会员仍有效。\n"); return; }
+/* jsonGetLong：读取整数值（接受数字或数字字符串），缺失或非整数返回 0 */
+static int jsonGetLong(const JsonField* fields, int n, const char* key, long* out) {
+    const char* v = jsonGet(fields, n, key);
+    if (!v || !*v) return 0;
+    char* end = NULL;
+    *out = strtol(v, &end, 10);
+    return *end == '\0';
+}
 
-    if (!prev) head = cur->next;
-    else prev->next = cur->next;
+/* batchResultBegin：写入结果行开头 {"line":N,"ok":true|false,"op":"..." */
+static void batchResultBegin(OutBuf* ob, int line_no, int ok, const char* op) {
+    obPuts(ob, "{\"line\":");
+    obLong(ob, line_no);
+    obPuts(ob, ok ? ",\"ok\":true" : ",\"ok\":false");
+    if (op) { obPuts(ob, ",\"op\":"); obJsonString(ob, op); }
+}
 
-    if (cur == tail) tail = prev;
+/* batchFail：写入一行失败结果 */
+static void batchFail(OutBuf* ob, int line_no, const char* op, const char* error) {
+    batchResultBegin(ob, line_no, 0, op);
+    obPuts(ob, ",\"error\":");
+    obJsonString(ob, error);
+    obPuts(ob, "}\n");
+}
 
-    free(cur);
-    member_count--;
+/* batchMemberResult：写入一行成功结果，附带会员当前完整信息；result 非 NULL 时一并写出 */
+static void batchMemberResult(OutBuf* ob, int line_no, const char* op, const char* result,
+                              const Node* p, long today) {
+    batchResultBegin(ob, line_no, 1, op);
+    if (result) { obPuts(ob, ",\"result\":"); obJsonString(ob, result); }
+    obPuts(ob, ",\"member\":");
+    writeExportFields(ob, EXPORT_JSONL, p, today);
+    obPuts(ob, "}}\n");
+}
 
-    saveToFile(DATA_FILE);
-    printf("会员已删除。(已保存)\n");
+/* query 结果回调上下文：输出缓冲 + 已写出卡号数 */
+typedef struct {
+    OutBuf* ob;
+    int written;
+} BatchQueryCtx;
+
+/* batchQueryVisit：query 结果回调，逐个写出匹配卡号 */
+static void batchQueryVisit(Node* p, void* ctx) {
+    BatchQueryCtx* qc = (BatchQueryCtx*)ctx;
+    if (qc->written++ > 0) obPutc(qc->ob, ',');
+    obLong(qc->ob, p->data.card_id);
 }
 
 /*
- * renewMember：会员续费/延长
- * 规则设计说明：
- *  1) 未到期且有效：仅允许同类型续费，通过 bonus_days 累加延长天数，不修改 membership_type
- *     （避免出现“390天月卡”等类型歧义，保持类型字段语义明确）
- *  2) 过期/注销：允许选择任意类型，从今天重新生效（更新 join_date，清空 bonus_days）
- *  3) 续费完成后写回文件
+ * batchExecute：执行一条已解析的操作，写出一行结果
+ * 返回值：1=成功，0=失败；*dirty 在内存数据被修改时置 1
  */
-void renewMember() {
-    syncAutoExpire();
+static int batchExecute(OutBuf* ob, int line_no, const JsonField* f, int n, int* dirty) {
+    const char* op = jsonGet(f, n, "op");
+    if (!op) { batchFail(ob, line_no, NULL, "缺少 op"); return 0; }
+
+    long today = clockToday();
+
+    if (strcmp(op, "checkpoint") == 0) {
+        if (*dirty && !saveToFile(DATA_FILE)) { batchFail(ob, line_no, op, "保存失败"); return 0; }
+        *dirty = 0;
+        batchResultBegin(ob, line_no, 1, op);
+        obPuts(ob, ",\"saved\":true}\n");
+        obFlush(ob);
+        return 1;
+    }
 
-    int id;
-    printf("请输入要续费的会员卡号: ");
-    if (scanf("%d", &id) != 1) { printf("输入错误！\n"); clearInputBuffer(); return; }
+    if (strcmp(op, "query") == 0) {
+        const char* where = jsonGet(f, n, "where");
+        Query q;
+        char err[64];
+        if (!compileQuery(where ? where : "", today, &q, err, sizeof(err))) {
+            char msg[96];
+            snprintf(msg, sizeof(msg), "条件无法识别: %s", err);
+            batchFail(ob, line_no, op, msg);
+            return 0;
+        }
+        batchResultBegin(ob, line_no, 1, op);
+        obPuts(ob, ",\"card_ids\":[");
+        BatchQueryCtx qc = { ob, 0 };
+        int matched = runQuery(&q, batchQueryVisit, &qc);
+        obPuts(ob, "],\"count\":");
+        obLong(ob, matched);
+        obPuts(ob, "}\n");
+        return 1;
+    }
 
-    Node* p = findByCardID(id);
-    if (!p) { printf("未找到该会员。\n"); return; }
+    if (strcmp(op, "add") == 0) {
+        const char* name = jsonGet(f, n, "name");
+        const char* gender = jsonGet(f, n, "gender");
+        const char* phone = jsonGet(f, n, "phone");
+        const char* type = jsonGet(f, n, "type");
+        long age = 0;
+        const char* reason = NULL;
+
+        if (member_count >= MAX_MEMBERS) reason = "会员库已满";
+        else if (!name || !*name || strlen(name) >= sizeof(((Member*)0)->name) || strpbrk(name, "| \t\r\n"))
+            reason = "姓名无效";
+        else if (!gender || (strcmp(gender, "男") != 0 && strcmp(gender, "女") != 0)) reason = "性别只能是 男/女";
+        else if (!jsonGetLong(f, n, "age", &age) || !isValidAge((int)age)) reason = "年龄需在18-80之间";
+        else if (!phone || !isValidPhone(phone)) reason = "电话必须是11位纯数字";
+        else if (!type || !(type = parseMemberType(type))) reason = "类型无效";
+        if (reason) { batchFail(ob, line_no, op, reason); return 0; }
 
-    int typeChoice;
-    char newType[10];
-    int newDuration = 0;
+        Member m;
+        m.card_id = next_card_id;
+        strcpy(m.name, name);
+        strcpy(m.gender, gender);
+        m.age = (int)age;
+        strcpy(m.phone, phone);
+        strcpy(m.join_date, clockTodayStr());
+        strcpy(m.membership_type, type);
+        m.is_active = 1;
 
-    while (1) {
-        printf("请选择续费类型:\n");
-        printf("  1. 月卡(30天)\n  2. 季卡(90天)\n  3. 年卡(365天)\n");
-        printf("请输入序号 (1-3): ");
-        if (scanf("%d", &typeChoice) != 1) {
-            printf("请输入数字！\n");
-            clearInputBuffer();
-            continue;
+        Node* node = createNode(&m);
+        if (!node || !appendNode(node)) {
+            freeNode(node);
+            batchFail(ob, line_no, op, "内存分配失败");
+            return 0;
         }
-        if (typeChoice == 1) { strcpy(newType, "月卡"); newDuration = 30; break; }
-        if (typeChoice == 2) { strcpy(newType, "季卡"); newDuration = 90; break; }
-        if (typeChoice == 3) { strcpy(newType, "年卡"); newDuration = 365; break; }
-        printf("输入错误，请输入 1、2 或 3！\n");
+        next_card_id++;
+        *dirty = 1;
+        batchMemberResult(ob, line_no, op, NULL, node, today);
+        return 1;
     }
 
-    char current_date_str[12];
-    getSystemDate(current_date_str);
-    long current_days = dateToDays(current_date_str);
+    /* 其余操作都针对已有会员 */
+    if (strcmp(op, "get") != 0 && strcmp(op, "phone") != 0 && strcmp(op, "renew") != 0 &&
+        strcmp(op, "cancel") != 0 && strcmp(op, "delete") != 0) {
+        batchFail(ob, line_no, op, "未知操作");
+        return 0;
+    }
 
-    long expire_days = calcExpireDays(p);
+    long id = 0;
+    if (!jsonGetLong(f, n, "card_id", &id) || id <= 0 || id > 0x7FFFFFFF) {
+        batchFail(ob, line_no, op, "card_id 无效");
+        return 0;
+    }
+    Node* p = findByCardID((int)id);
+    if (!p) { batchFail(ob, line_no, op, cardNotFoundReason((int)id)); return 0; }
 
-    /* 过期/注销：从今天重新购买并生效，允许切换类型 */
-    if (p->data.is_active == 0 || expire_days < current_days) {
-        strcpy(p->data.join_date, current_date_str);
-        p->bonus_days = 0;
-        strcpy(p->data.membership_type, newType);
-        p->data.is_active = 1;
+    if (strcmp(op, "get") == 0) {
+        batchMemberResult(ob, line_no, op, NULL, p, today);
+        return 1;
+    }
 
-        saveToFile(DATA_FILE);
-        printf(">>> 续费成功！已从今天(%s)重新生效，类型：%s (已保存)\n",
-               current_date_str, p->data.membership_type);
-        return;
+    if (strcmp(op, "phone") == 0) {
+        const char* phone = jsonGet(f, n, "phone");
+        if (!phone || !isValidPhone(phone)) { batchFail(ob, line_no, op, "电话必须是11位纯数字"); return 0; }
+        strcpy(p->data.phone, phone);
+        invalidateRowCache(p);
+        emitChange(CHANGE_UPDATED, p);
+        *dirty = 1;
+        batchMemberResult(ob, line_no, op, NULL, p, today);
+        return 1;
     }
 
-    /* 未到期：仅允许同类型续费，类型不同则拒绝 */
-    if (strcmp(newType, p->data.membership_type) != 0) {
-        printf("续费失败：该会员仍在有效期内，不能更换类型。\n");
-        printf("当前类型：%s。若需更换类型，请等待到期或先手动注销后再购买新类型。\n",
-               p->data.membership_type);
-        return;
+    if (strcmp(op, "renew") == 0) {
+        const char* type = jsonGet(f, n, "type");
+        const char* newType = type ? parseMemberType(type) : NULL;
+        if (!newType) { batchFail(ob, line_no, op, "类型无效"); return 0; }
+        RenewResult r = applyRenewal(p, newType, today);
+        if (r == RENEW_TYPE_MISMATCH) { batchFail(ob, line_no, op, "仍在有效期内，不能更换类型"); return 0; }
+        *dirty = 1;
+        batchMemberResult(ob, line_no, op, r == RENEW_RESTARTED ? "restarted" : "extended", p, today);
+        return 1;
     }
 
-    p->bonus_days += newDuration;
-    p->data.is_active = 1;
+    if (strcmp(op, "cancel") == 0) {
+        if (!isMemberActive(p, today)) { batchFail(ob, line_no, op, "该会员已是过期/注销状态"); return 0; }
+        p->data.is_active = 0;
+        refreshExpiryIndexes(p);
+        *dirty = 1;
+        batchMemberResult(ob, line_no, op, NULL, p, today);
+        return 1;
+    }
 
-    saveToFile(DATA_FILE);
-    printf(">>> 续费成功！已延长 %d 天，类型仍为：%s (已保存)\n",
-           newDuration, p->data.membership_type);
+    /* delete */
+    if (isMemberActive(p, today)) { batchFail(ob, line_no, op, "会员仍有效"); return 0; }
+    removeMember(p);
+    *dirty = 1;
+    batchResultBegin(ob, line_no, 1, op);
+    obPuts(ob, ",\"card_id\":");
+    obLong(ob, id);
+    obPuts(ob, "}\n");
+    return 1;
 }
 
 /*
- * searchByCardID：按卡号精确查询
+ * runBatch：批处理主循环（path 为 "-" 时读取标准输入）
  * 关键点：
- *  - 查询前先 syncAutoExpire 确保状态实时
- *  - 有效会员额外输出剩余天数；过期会员显示 ---
+ *  - 空行与 # 开头的行忽略，行号按输入文件计
+ *  - 结果经输出缓冲写到标准输出，checkpoint 与结束时刷新
+ *  - 有修改时在 checkpoint 与结束时保存；调度器每条操作前心跳一次（到期事件只写日志）
+ * 返回值（进程退出码）：全部成功为 0；有操作失败或保存失败为 1；无法打开输入为 2
  */
-void searchByCardID() {
-    syncAutoExpire();
-
-    int id;
-    printf("请输入查询卡号: ");
-    if (scanf("%d", &id) != 1) { printf("输入错误！\n"); clearInputBuffer(); return; }
-
-    Node* p = findByCardID(id);
-    if (!p) { printf("未找到卡号 %d\n", id); return; }
-
-    printf("\n>>> 查询结果:\n");
-    printf("卡号: %d\n", p->data.card_id);
-    printf("姓名: %s\n", p->data.name);
-    printf("类型: %s\n", p->data.membership_type);
-    printf("状态: %s\n", p->data.is_active ? "有效" : "过期");
-    printf("入会日期: %s\n", p->data.join_date);
+int runBatch(const char* path) {
+    FILE* in = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+    if (!in) { fprintf(stderr, "无法打开批处理文件 %s\n", path); return 2; }
+
+    OutBuf ob;
+    obInit(&ob, stdout);
+
+    char line[BATCH_LINE_MAX];
+    JsonField fields[MAX_JSON_FIELDS];
+    int line_no = 0, failed = 0, dirty = 0;
+
+    while (fgets(line, sizeof(line), in)) {
+        line_no++;
+        size_t len = strlen(line);
+        if (len == sizeof(line) - 1 && line[len - 1] != '\n') {
+            int c;
+            while ((c = fgetc(in)) != '\n' && c != EOF);
+            batchFail(&ob, line_no, NULL, "行过长");
+            failed++;
+            continue;
+        }
+        trim_newline(line);
+        const char* s = jsonSkipSpace(line);
+        if (*s == '\0' || *s == '#') continue;
 
-    char current_date_str[12];
-    getSystemDate(current_date_str);
-    long current_days = dateToDays(current_date_str);
+        schedulerTick();
+        int n = parseJsonObject(s, fields, MAX_JSON_FIELDS);
+        if (n < 0) { batchFail(&ob, line_no, NULL, "JSON 格式错误"); failed++; continue; }
+        if (!batchExecute(&ob, line_no, fields, n, &dirty)) failed++;
+    }
+    if (in != stdin) fclose(in);
 
-    if (p->data.is_active == 1) {
-        long days_left = calcExpireDays(p) - current_days;
-        printf("剩余天数: %ld 天\n", days_left);
-    } else {
-        printf("剩余天数: ---\n");
+    if (dirty && !saveToFile(DATA_FILE)) {
+        fprintf(stderr, "保存 %s 失败\n", DATA_FILE);
+        failed++;
     }
+    obFlush(&ob);
+    fflush(stdout);
+    return failed ? 1 : 0;
 }
 
+/* =========================================================
+ *  初次运行测试数据：当 members.txt 不存在/无有效数据时使用
+ * ========================================================= */
+
 /*
- * searchByName：按姓名关键字模糊查询
- * 关键点：
- *  - 使用 strstr 实现子串匹配
- *  - 输出简表，便于管理员快速定位
+ * initTestData：生成初始演示数据并保存至 members.txt
+ * 说明：用于首次运行或测试环境缺少数据文件时保证程序可直接演示
  */
-void searchByName() {
-    syncAutoExpire();
+void initTestData() {
+    freeAllMembers();
 
-    char key[30];
-    printf("请输入姓名关键字: ");
-    scanf("%29s", key);
+    Member m1 = {1001, "张三", "男", 25, "13800138000", "2025-12-01", "年卡", 1};
+    Member m2 = {1002, "李四", "女", 30, "13912345678", "2024-06-15", "月卡", 0};
+    Member m3 = {1003, "王五", "男", 45, "13666666666", "2026-01-01", "月卡", 1};
+    Member m4 = {1004, "赵六", "女", 22, "13777777777", "2025-11-01", "季卡", 1};
 
-    int found = 0;
-    printf("\n>>> 搜索结果:\n");
-    printSeparator();
-    printWithPad("卡号", W_CARD);   putchar(' ');
-    printWithPad("姓名", W_NAME);   putchar(' ');
-    printWithPad("类型", W_TYPE);   putchar(' ');
-    printWithPad("状态", W_STATUS); putchar('\n');
-    printSeparator();
+    Node* nodes[4] = {createNode(&m1), createNode(&m2), createNode(&m3), createNode(&m4)};
 
-    for (Node* p = head; p; p = p->next) {
-        if (strstr(p->data.name, key)) {
-            printf("%-*d ", W_CARD, p->data.card_id);
-            printWithPad(p->data.name, W_NAME);                    putchar(' ');
-            printWithPad(p->data.membership_type, W_TYPE);         putchar(' ');
-            printWithPad(p->data.is_active ? "有效" : "过期", W_STATUS);
-            putchar('\n');
-            found = 1;
+    /* 任一结点创建或追加失败：释放尚未挂入链表的结点（已挂入的由 freeAllMembers 统一释放） */
+    for (int i = 0; i < 4; i++) {
+        if (nodes[i] && appendNode(nodes[i])) continue;
+        for (int k = i; k < 4; k++) {
+            if (nodes[k]) freeNode(nodes[k]);
         }
+        return;
     }
 
-    if (!found) printf("未找到。\n");
-    printSeparator();
+    next_card_id = 1005;
+    saveToFile(DATA_FILE);
 }
 
-/*
- * updateMemberStatus：手动注销/标记过期（不可逆）
- * 设计意义：处理“退会/违规停用”等非自然到期场景，与自动到期同步互补
- * 关键点：
- *  - 仅修改 is_active 字段为 0
- *  - 修改后写回文件
- */
-void updateMemberStatus() {
-    int id;
-    printf("请输入要注销/标记过期的卡号: ");
-    if (scanf("%d", &id) != 1) { printf("输入错误！\n"); clearInputBuffer(); return; }
+/* =========================================================
+ *  基准测试（仅在 -DGYM_BENCH 编译时包含）
+ *  用法：./a.out --bench <名称>
+ *    date   随机日期的 dateToDays / daysToDate 吞吐量，并与旧版 sscanf 实现对比
+ *    expire 到期日列批量判定：SIMD 与标量循环对比
+ *    hist   剩余天数分布：日桶增量计数与全量扫描对比
+ *    io     100 万会员的保存与列表吞吐量（./a.out --bench io > /dev/null，结果输出到 stderr）
+ *    export 100 万会员导出 CSV / JSON Lines 的吞吐量
+ *    sort   排序排列的首次建立与增量维护
+ *    width  UTF-8 显示宽度计算：查表与旧版逐字解码对比
+ *    dash   实时统计看板：增量维护与每次重新统计对比（./a.out --bench dash > /dev/null）
+ * ========================================================= */
+#ifdef GYM_BENCH
+
+/* benchRand：xorshift32 伪随机数，保证各次运行数据一致 */
+static uint32_t bench_seed = 2463534242u;
+static uint32_t benchRand() {
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 17;
+    bench_seed ^= bench_seed << 5;
+    return bench_seed;
+}
 
-    Node* p = findByCardID(id);
-    if (!p) { printf("未找到该会员。\n"); return; }
+/* benchSeconds：处理器时间（秒） */
+static double benchSeconds() {
+    return (double)clock() / CLOCKS_PER_SEC;
+}
 
-    if (p->data.is_active == 0) {
-        printf("该会员已是过期/注销状态。\n");
-        return;
+/* dateToDaysLegacy：旧版实现（sscanf + 逐月累加），作为对照组 */
+static long dateToDaysLegacy(const char* date) {
+    int y, m, d;
+    if (sscanf(date, "%d-%d-%d", &y, &m, &d) != 3) return 0;
+    if (m < 1 || m > 12) return 0;
+    if (d < 1 || d > daysInMonth(y, m)) return 0;
+
+    long y1 = y - 1;
+    long days = (long)y * 365 + y1 / 4 - y1 / 100 + y1 / 400;
+    for (int i = 1; i < m; i++) days += daysInMonth(y, i);
+    return days + d;
+}
+
+/* benchDate：随机日期（1970~2099）解析与往返转换 */
+static int benchDate() {
+    enum { N = 2000000 };
+    char (*dates)[12] = malloc((size_t)N * sizeof(*dates));
+    if (!dates) return 1;
+
+    for (int i = 0; i < N; i++) {
+        int y = 1970 + (int)(benchRand() % 130);
+        int m = 1 + (int)(benchRand() % 12);
+        int d = 1 + (int)(benchRand() % (uint32_t)daysInMonth(y, m));
+        sprintf(dates[i], "%04d-%02d-%02d", y, m, d);
     }
 
-    p->data.is_active = 0;
+    long sum_legacy = 0, sum_new = 0;
+    double t0 = benchSeconds();
+    for (int i = 0; i < N; i++) sum_legacy += dateToDaysLegacy(dates[i]);
+    double t1 = benchSeconds();
+    for (int i = 0; i < N; i++) sum_new += dateToDays(dates[i]);
+    double t2 = benchSeconds();
+
+    char buf[12];
+    int mismatches = 0;
+    for (int i = 0; i < N; i++) {
+        daysToDate(dateToDays(dates[i]), buf);
+        if (strcmp(buf, dates[i]) != 0) mismatches++;
+    }
+    double t3 = benchSeconds();
 
-    saveToFile(DATA_FILE);
-    printf("会员 %s 已注销/标记为过期。(已保存)\n", p->data.name);
+    printf("dateToDays (旧版 sscanf)  : %8.1f 万次/秒\n", N / (t1 - t0 + 1e-9) / 1e4);
+    printf("dateToDays (查表)         : %8.1f 万次/秒\n", N / (t2 - t1 + 1e-9) / 1e4);
+    printf("dateToDays + daysToDate   : %8.1f 万次/秒\n", N / (t3 - t2 + 1e-9) / 1e4);
+    printf("结果校验: 累计值%s，往返不一致 %d 条\n", sum_legacy == sum_new ? "一致" : "不一致", mismatches);
+
+    free(dates);
+    return (sum_legacy == sum_new && mismatches == 0) ? 0 : 1;
+}
+
+/* benchExpire：批量到期判定，SIMD 与标量循环对比（400 万条到期日列） */
+static int benchExpire() {
+    enum { N = 4000000, ROUNDS = 20 };
+    int32_t* col = (int32_t*)malloc((size_t)N * sizeof(int32_t));
+    uint64_t* bits_simd = (uint64_t*)malloc(((size_t)N + 63) / 64 * sizeof(uint64_t));
+    uint64_t* bits_scalar = (uint64_t*)malloc(((size_t)N + 63) / 64 * sizeof(uint64_t));
+    if (!col || !bits_simd || !bits_scalar) return 1;
+
+    int32_t today = (int32_t)dateToDays("2026-01-01");
+    for (int i = 0; i < N; i++) {
+        col[i] = (benchRand() % 10 == 0) ? INT32_MIN : today - 400 + (int32_t)(benchRand() % 800);
+    }
+
+    long total_scalar = 0, total_simd = 0;
+    double t0 = benchSeconds();
+    for (int r = 0; r < ROUNDS; r++) total_scalar = bulkEvalActiveScalar(col, N, today, bits_scalar);
+    double t1 = benchSeconds();
+    for (int r = 0; r < ROUNDS; r++) total_simd = bulkEvalActive(col, N, today, bits_simd);
+    double t2 = benchSeconds();
+
+    int same = total_scalar == total_simd &&
+               memcmp(bits_scalar, bits_simd, ((size_t)N + 63) / 64 * sizeof(uint64_t)) == 0;
+    printf("标量循环 : %8.1f 百万条/秒\n", (double)N * ROUNDS / (t1 - t0 + 1e-9) / 1e6);
+    printf("SIMD     : %8.1f 百万条/秒 (%s)\n", (double)N * ROUNDS / (t2 - t1 + 1e-9) / 1e6,
+#if defined(__AVX2__)
+           "AVX2"
+#elif defined(__SSE2__)
+           "SSE2"
+#else
+           "未启用"
+#endif
+           );
+    printf("有效总数: %ld，位图%s\n", total_simd, same ? "一致" : "不一致");
+
+    free(col);
+    free(bits_simd);
+    free(bits_scalar);
+    return same ? 0 : 1;
+}
+
+/* benchFillMembers：生成 n 条合成会员数据（绕过 MAX_MEMBERS，仅供基准测试） */
+static int benchFillMembers(int n) {
+    static const char* types[] = {"月卡", "季卡", "年卡"};
+    static const char* names[] = {"张三", "李四", "henry", "王小明", "nine19een", "欧阳娜娜"};
+    freeAllMembers();
+    long base = dateToDays("2025-01-01");
+    for (int i = 0; i < n; i++) {
+        Member m;
+        m.card_id = 1001 + i;
+        snprintf(m.name, sizeof(m.name), "%s%d", names[benchRand() % 6], i % 1000);
+        strcpy(m.gender, (benchRand() & 1) ? "男" : "女");
+        m.age = 18 + (int)(benchRand() % 63);
+        snprintf(m.phone, sizeof(m.phone), "1%010u", benchRand() % 1000000000u);
+        daysToDate(base + (long)(benchRand() % 600), m.join_date);
+        strcpy(m.membership_type, types[benchRand() % 3]);
+        m.is_active = (benchRand() % 10) != 0;
+
+        Node* node = createNode(&m);
+        if (!node || !appendNode(node)) { freeNode(node); return 0; }
+        node->renew_periods = (benchRand() % 4 == 0) ? 1 : 0;
+        updateExpireDay(node);
+    }
+    next_card_id = 1001 + n;
+    return 1;
 }
 
 /*
- * showStatistics：统计分析
- * 输出内容：
- *  - 有效会员总数
- *  - 月卡/季卡/年卡数量与占比
- *  - 30天内到期提醒（依据剩余天数筛选）
+ * benchIO：100 万会员的保存与列表吞吐量（表格后端首次/行缓存，以及 plain/machine 后端）
+ * 说明：列表输出写到 stdout，计时结果写到 stderr；运行时请将 stdout 重定向到 /dev/null
  */
-void showStatistics() {
-    syncAutoExpire();
+static int benchIO() {
+    enum { N = 1000000 };
+    clockSetFixed(dateToDays("2026-01-01"));
+    if (!benchFillMembers(N)) return 1;
+
+    FILE* fp = tmpfile();
+    if (!fp) return 1;
+    double t0 = benchSeconds();
+    int ok = writeMembers(fp);
+    double t1 = benchSeconds();
+    long bytes = ftell(fp);
+    fclose(fp);
 
-    if (member_count == 0) { printf("暂无数据。\n"); return; }
+    listMembers(LIST_INSERTION);
+    fflush(stdout);
+    double t2 = benchSeconds();
+    listMembers(LIST_INSERTION);
+    fflush(stdout);
+    double t3 = benchSeconds();
+    selectOutputBackend("plain");
+    listMembers(LIST_INSERTION);
+    fflush(stdout);
+    double t4 = benchSeconds();
+    selectOutputBackend("machine");
+    listMembers(LIST_INSERTION);
+    fflush(stdout);
+    double t5 = benchSeconds();
+    selectOutputBackend("table");
+
+    fprintf(stderr, "保存 %d 条: %.3f 秒 (%.1f MB/s)\n", N, t1 - t0, bytes / (t1 - t0 + 1e-9) / 1e6);
+    fprintf(stderr, "列表 %d 条: %.3f 秒（首次排版） %.3f 秒（行缓存）\n", N, t2 - t1, t3 - t2);
+    fprintf(stderr, "列表 %d 条: %.3f 秒（plain） %.3f 秒（machine）\n", N, t4 - t3, t5 - t4);
 
-    int active_count = 0;
-    int type_month = 0, type_season = 0, type_year = 0;
+    freeAllMembers();
+    return ok ? 0 : 1;
+}
 
-    char current_date_str[12];
-    getSystemDate(current_date_str);
-    long current_days = dateToDays(current_date_str);
+/* benchExport：100 万会员导出 CSV / JSON Lines 的吞吐量（写入临时文件） */
+static int benchExport() {
+    enum { N = 1000000 };
+    clockSetFixed(dateToDays("2026-01-01"));
+    if (!benchFillMembers(N)) return 1;
+    schedulerTick();
+
+    static const char* names[] = {"CSV", "JSON Lines"};
+    int ok = 1;
+    for (int f = 0; f < 2; f++) {
+        FILE* fp = tmpfile();
+        if (!fp) return 1;
+        double t0 = benchSeconds();
+        long rows = exportMembers(fp, f == 0 ? EXPORT_CSV : EXPORT_JSONL, NULL, clockToday());
+        double t1 = benchSeconds();
+        long bytes = ftell(fp);
+        fclose(fp);
+        ok &= rows == N;
+        printf("%-10s %ld 条: %.3f 秒 (%.1f MB/s)\n", names[f], rows, t1 - t0, bytes / (t1 - t0 + 1e-9) / 1e6);
+    }
 
-    printf("\n======= 统计分析报表 =======\n");
-    printf("系统当前日期: %s\n", current_date_str);
+    freeAllMembers();
+    return ok ? 0 : 1;
+}
 
-    for (Node* p = head; p; p = p->next) {
-        if (p->data.is_active == 1) {
-            active_count++;
-            if (strcmp(p->data.membership_type, "月卡") == 0) type_month++;
-            else if (strcmp(p->data.membership_type, "季卡") == 0) type_season++;
-            else if (strcmp(p->data.membership_type, "年卡") == 0) type_year++;
+/*
+ * benchSort：100 万会员的排序排列
+ * 对比：首次建立（整体排序）、已建立后再次取用、续费/注销引起的增量维护；最后与重新排序的结果逐项核对
+ */
+static int benchSort() {
+    enum { N = 1000000, MUTATIONS = 2000 };
+    static const char* types[] = {"月卡", "季卡", "年卡"};
+    clockSetFixed(dateToDays("2026-01-01"));
+    if (!benchFillMembers(N)) return 1;
+    long today = clockToday();
+
+    double t0 = benchSeconds();
+    for (int o = LIST_INSERTION + 1; o < LIST_ORDERS; o++) if (!sortPermGet((ListOrder)o)) return 1;
+    double t1 = benchSeconds();
+    for (int o = LIST_INSERTION + 1; o < LIST_ORDERS; o++) sortPermGet((ListOrder)o);
+    double t2 = benchSeconds();
+    for (int i = 0; i < MUTATIONS; i++) {
+        Node* p = card_index[benchRand() % N];
+        if (benchRand() % 4 == 0 && p->data.is_active == 1) {
+            p->data.is_active = 0;
+            refreshExpiryIndexes(p);
+        } else {
+            applyRenewal(p, types[benchRand() % 3], today);
         }
     }
-
-    printf("---------------------------\n");
-    printf("有效会员总数: %d 人\n", active_count);
-    if (active_count > 0) {
-        printf("  - 月卡: %d (%.1f%%)\n", type_month, (float)type_month / active_count * 100);
-        printf("  - 季卡: %d (%.1f%%)\n", type_season, (float)type_season / active_count * 100);
-        printf("  - 年卡: %d (%.1f%%)\n", type_year, (float)type_year / active_count * 100);
+    double t3 = benchSeconds();
+
+    int same = 1;
+    Node** check = (Node**)malloc((size_t)N * sizeof(Node*));
+    if (!check) return 1;
+    for (int o = LIST_INSERTION + 1; o < LIST_ORDERS; o++) {
+        memcpy(check, sort_perm[o], (size_t)N * sizeof(Node*));
+        sortPermDrop((ListOrder)o);
+        same &= memcmp(check, sortPermGet((ListOrder)o), (size_t)N * sizeof(Node*)) == 0;
     }
+    free(check);
 
-    printf("---------------------------\n");
-    printf(">>> 即将到期会员提示 (30天内):\n");
+    printf("首次建立 4 种排列: %8.3f 秒\n", t1 - t0);
+    printf("再次取用 4 种排列: %8.6f 秒\n", t2 - t1);
+    printf("增量维护 %d 次修改: %8.3f 秒 (%.1f 微秒/次)\n", MUTATIONS, t3 - t2, (t3 - t2) * 1e6 / MUTATIONS);
+    printf("与重新排序结果%s\n", same ? "一致" : "不一致");
 
-    int warning_count = 0;
-    for (Node* p = head; p; p = p->next) {
-        if (p->data.is_active == 1) {
-            long days_left = calcExpireDays(p) - current_days;
-            if (days_left >= 0 && days_left <= 30) {
-                printf("  [警告] 卡号:%d 姓名:%s 还有 %ld 天到期！\n",
-                       p->data.card_id, p->data.name, days_left);
-                warning_count++;
-            }
+    freeAllMembers();
+    return same ? 0 : 1;
+}
+
+/*
+ * benchDashboard：100 万会员的实时统计看板
+ * 对比：每次修改后重新统计（有效位图 + 到期窗口）与变更通知增量维护后刷新；最后与重新统计的结果核对
+ * 说明：看板输出写到 stdout，计时结果写到 stderr；运行时请将 stdout 重定向到 /dev/null
+ */
+static int benchDashboard() {
+    enum { N = 1000000, RESCANS = 100, MUTATIONS = 2000 };
+    static const char* types[] = {"月卡", "季卡", "年卡"};
+    clockSetFixed(dateToDays("2026-01-01"));
+    if (!benchFillMembers(N)) return 1;
+    schedulerTick();
+    long today = clockToday();
+
+    int by_type[MEMBER_TYPES];
+    double t0 = benchSeconds();
+    for (int i = 0; i < RESCANS; i++) {
+        countActiveByType(today, by_type);
+        forEachExpiring(today, DASH_WINDOW, NULL, NULL);
+    }
+    double t1 = benchSeconds();
+
+    toggleDashboard();
+    double t2 = benchSeconds();
+    for (int i = 0; i < MUTATIONS; i++) {
+        Node* p = card_index[benchRand() % N];
+        if (benchRand() % 4 == 0 && p->data.is_active == 1) {
+            p->data.is_active = 0;
+            refreshExpiryIndexes(p);
+        } else {
+            applyRenewal(p, types[benchRand() % 3], today);
         }
+        dashboardTick();
     }
+    fflush(stdout);
+    double t3 = benchSeconds();
 
-    if (warning_count == 0) printf("  暂无即将到期的会员。\n");
-    printf("=============================\n");
+    countActiveByType(today, by_type);
+    int same = memcmp(by_type, dashboard.active, sizeof(by_type)) == 0 &&
+               dashboard.shown_expiring == forEachExpiring(today, DASH_WINDOW, NULL, NULL);
+
+    fprintf(stderr, "每次重新统计: %8.3f 毫秒/次\n", (t1 - t0) * 1e3 / RESCANS);
+    fprintf(stderr, "增量维护 + 刷新 %d 次修改: %8.3f 秒 (%.1f 微秒/次)\n", MUTATIONS, t3 - t2, (t3 - t2) * 1e6 / MUTATIONS);
+    fprintf(stderr, "与重新统计结果%s\n", same ? "一致" : "不一致");
+
+    freeAllMembers();
+    return same ? 0 : 1;
 }
 
-/* =========================================================
- *  初次运行测试数据：当 members.txt 不存在/无有效数据时使用
- * ========================================================= */
+/* benchHistogram：剩余天数分布，增量计数与全量扫描对比，并校验跨日推进后结果一致 */
+static int benchHistogram() {
+    enum { N = 1000000, ROUNDS = 20 };
+    clockSetFixed(dateToDays("2026-01-01"));
+    if (!benchFillMembers(N)) return 1;
+    schedulerTick();
+
+    int same = 1;
+    for (int step = 0; step < 3; step++) {
+        long today = clockToday();
+        ExpiryHistogram a, b;
+        double t0 = benchSeconds();
+        for (int r = 0; r < ROUNDS; r++) buildHistogramScan(today, &a);
+        double t1 = benchSeconds();
+        for (int r = 0; r < ROUNDS; r++) buildHistogramIncremental(today, &b);
+        double t2 = benchSeconds();
+
+        int eq = memcmp(&a, &b, sizeof(a)) == 0;
+        same &= eq;
+        printf("%s  全量扫描: %8.3f 毫秒/次  增量计数: %8.4f 毫秒/次  结果%s\n", clockTodayStr(),
+               (t1 - t0) * 1000 / ROUNDS, (t2 - t1) * 1000 / ROUNDS, eq ? "一致" : "不一致");
+
+        clockSetFixed(today + 45);
+        schedulerTick();
+    }
 
-/*
- * initTestData：生成初始演示数据并保存至 members.txt
- * 说明：用于首次运行或测试环境缺少数据文件时保证程序可直接演示
- */
-void initTestData() {
     freeAllMembers();
+    return same ? 0 : 1;
+}
 
-    Member m1 = {1001, "张三", "男", 25, "13800138000", "2025-12-01", "年卡", 1};
-    Member m2 = {1002, "李四", "女", 30, "13912345678", "2024-06-15", "月卡", 0};
-    Member m3 = {1003, "王五", "男", 45, "13666666666", "2026-01-01", "月卡", 1};
-    Member m4 = {1004, "赵六", "女", 22, "13777777777", "2025-11-01", "季卡", 1};
+/* utf8DecodeLegacy / isCjkWideLegacy / measureTextLegacy：旧版逐字节分支解码 + 区间比较链，作为对照组 */
+static uint32_t utf8DecodeLegacy(const char *s, int *bytes) {
+    unsigned char c = (unsigned char)s[0];
+
+    if (c < 0x80) { *bytes = 1; return c; }
+    if ((c & 0xE0) == 0xC0) {
+        *bytes = 2;
+        return ((uint32_t)(c & 0x1F) << 6) | ((uint32_t)((unsigned char)s[1] & 0x3F));
+    }
+    if ((c & 0xF0) == 0xE0) {
+        *bytes = 3;
+        return ((uint32_t)(c & 0x0F) << 12) |
+               ((uint32_t)((unsigned char)s[1] & 0x3F) << 6) |
+               ((uint32_t)((unsigned char)s[2] & 0x3F));
+    }
+    if ((c & 0xF8) == 0xF0) {
+        *bytes = 4;
+        return ((uint32_t)(c & 0x07) << 18) |
+               ((uint32_t)((unsigned char)s[1] & 0x3F) << 12) |
+               ((uint32_t)((unsigned char)s[2] & 0x3F) << 6) |
+               ((uint32_t)((unsigned char)s[3] & 0x3F));
+    }
+    *bytes = 1;
+    return c;
+}
+
+static int isCjkWideLegacy(uint32_t u) {
+    return
+        (u >= 0x1100 && u <= 0x115F) ||
+        (u >= 0x2E80 && u <= 0xA4CF) ||
+        (u >= 0xAC00 && u <= 0xD7A3) ||
+        (u >= 0xF900 && u <= 0xFAFF) ||
+        (u >= 0xFE10 && u <= 0xFE19) ||
+        (u >= 0xFE30 && u <= 0xFE6F) ||
+        (u >= 0xFF00 && u <= 0xFF60) ||
+        (u >= 0xFFE0 && u <= 0xFFE6) ||
+        (u >= 0x20000 && u <= 0x3FFFD);
+}
+
+static int measureTextLegacy(const char* s) {
+    int used = 0;
+    for (int i = 0; s[i]; ) {
+        int b = 0;
+        uint32_t u = utf8DecodeLegacy(s + i, &b);
+        if (b <= 0) b = 1;
+        used += u == 0 ? 0 : (isCjkWideLegacy(u) ? 2 : 1);
+        i += b;
+    }
+    return used;
+}
+
+/* benchWidth：中英文混排字符串显示宽度计算（旧版逐字解码 vs 查表 + ASCII 快速路径） */
+static int benchWidth() {
+    enum { N = 4096, ROUNDS = 500, TRIALS = 7 };
+    static const char* parts[] = {
+        "张", "王", "李", "欧阳", "Anna", "nine19een", "Müller", "ｆｕｌｌ", "김", "-", "Li", "Chen"
+    };
+    char (*texts)[32] = malloc((size_t)N * sizeof(*texts));
+    if (!texts) return 1;
+
+    for (int i = 0; i < N; i++) {
+        size_t len = 0;
+        texts[i][0] = '\0';
+        int pieces = 1 + (int)(benchRand() % 4);
+        for (int k = 0; k < pieces; k++) {
+            const char* part = parts[benchRand() % (sizeof(parts) / sizeof(parts[0]))];
+            size_t pl = strlen(part);
+            if (len + pl >= sizeof(texts[i])) break;
+            memcpy(texts[i] + len, part, pl + 1);
+            len += pl;
+        }
+    }
 
-    Node* n1 = createNode(&m1);
-    Node* n2 = createNode(&m2);
-    Node* n3 = createNode(&m3);
-    Node* n4 = createNode(&m4);
+    long sum_legacy = 0, sum_new = 0;
+    int cut = 0, cut_width = 0;
+    measureText("", W_NAME, &cut, &cut_width);   /* 预先生成宽度表，不计入计时 */
+    double best_legacy = 1e9, best_new = 1e9;
+    for (int trial = 0; trial < TRIALS; trial++) {
+        sum_legacy = sum_new = 0;
+        double t0 = benchSeconds();
+        for (int r = 0; r < ROUNDS; r++)
+            for (int i = 0; i < N; i++) sum_legacy += measureTextLegacy(texts[i]);
+        double t1 = benchSeconds();
+        for (int r = 0; r < ROUNDS; r++)
+            for (int i = 0; i < N; i++) sum_new += measureText(texts[i], W_NAME, &cut, &cut_width);
+        double t2 = benchSeconds();
+        if (t1 - t0 < best_legacy) best_legacy = t1 - t0;
+        if (t2 - t1 < best_new) best_new = t2 - t1;
+    }
 
-    if (!n1 || !n2 || !n3 || !n4) return;
+    printf("逐字解码 + 区间比较 : %8.1f 万个字符串/秒\n", (double)N * ROUNDS / (best_legacy + 1e-9) / 1e4);
+    printf("查表 + ASCII 快速路径: %8.1f 万个字符串/秒\n", (double)N * ROUNDS / (best_new + 1e-9) / 1e4);
+    printf("结果校验: 总宽度%s\n", sum_legacy == sum_new ? "一致" : "不一致");
 
-    appendNode(n1);
-    appendNode(n2);
-    appendNode(n3);
-    appendNode(n4);
+    free(texts);
+    return sum_legacy == sum_new ? 0 : 1;
+}
 
-    next_card_id = 1005;
-    syncAutoExpire();
-    saveToFile(DATA_FILE);
+/* runBenchmark：按名称分派基准测试 */
+static int runBenchmark(const char* name) {
+    if (strcmp(name, "sort") == 0) return benchSort();
+    if (strcmp(name, "dash") == 0) return benchDashboard();
+    if (strcmp(name, "export") == 0) return benchExport();
+    if (strcmp(name, "width") == 0) return benchWidth();
+    if (strcmp(name, "hist") == 0) return benchHistogram();
+    if (strcmp(name, "io") == 0) return benchIO();
+    if (strcmp(name, "date") == 0) return benchDate();
+    if (strcmp(name, "expire") == 0) return benchExpire();
+    printf("未知基准测试: %s\n", name);
+    return 1;
 }
 
+#endif /* GYM_BENCH */
+
 /* =========================================================
  *  主函数：程序入口
  * ========================================================= */
@@ -982,16 +5017,51 @@ void initTestData() {
 /*
  * main：
  *  - Windows 下切换控制台为 UTF-8（防止中文乱码）
- *  - 启动时优先读取 members.txt；若读取失败则生成测试数据
- *  - 主菜单循环驱动各模块
+ *  - 环境变量 GYM_TODAY=YYYY-MM-DD 可固定“今天”，用于测试与演示
+ *  - gym --batch <文件|-> 进入批处理命令模式：不显示菜单、不生成测试数据，处理完输入即退出
+ *  - gym --output <table|plain|machine> 选择列表/查询/统计界面的输出后端（默认 table）
+ *  - 参数逐个扫描：未知选项或缺少取值时打印用法并以状态码 2 退出
+ *  - 启动时读取布隆过滤器，再优先读取 members.txt；若读取失败则生成测试数据
+ *  - 注册到期事件订阅者；主菜单循环驱动各模块，每次交互前执行调度器心跳
+ *  - 所有提示经行缓冲读取器取输入；输入结束时逐级返回主菜单并按“0 退出”保存退出
  *  - 退出前保存数据并释放链表内存
  */
-int main() {
+int main(int argc, char* argv[]) {
+#ifdef GYM_BENCH
+    if (argc >= 3 && strcmp(argv[1], "--bench") == 0) return runBenchmark(argv[2]);
+#endif
+    const char* batch_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        int is_batch = strcmp(argv[i], "--batch") == 0;
+        if ((!is_batch && strcmp(argv[i], "--output") != 0) || i + 1 >= argc) {
+            fprintf(stderr, "未知或缺少取值的参数: %s\n"
+                            "用法: gym [--batch <文件|->] [--output <table|plain|machine>]\n", argv[i]);
+            return 2;
+        }
+        const char* value = argv[++i];      /* 识别出选项后才消耗其取值 */
+        if (is_batch) {
+            batch_path = value;
+        } else if (!selectOutputBackend(value)) {
+            fprintf(stderr, "未知输出格式: %s（可选 table/plain/machine）\n", value);
+            return 2;
+        }
+    }
+
 #ifdef _WIN32
-    system("chcp 65001");
+    if (!batch_path) system("chcp 65001");
 #endif
 
+    const char* fixed_today = getenv("GYM_TODAY");
+    if (fixed_today && dateToDays(fixed_today) > 0) clockSetFixed(dateToDays(fixed_today));
+
+    loadBloom(BLOOM_FILE);
     int loaded = loadFromFile(DATA_FILE);
+    if (batch_path) {
+        expirySubscribe(expiryLogListener, (void*)EXPIRY_LOG_FILE);
+        int rc = runBatch(batch_path);
+        freeAllMembers();
+        return rc;
+    }
     if (loaded <= 0) {
         printf("提示：未检测到有效数据文件，已生成初始测试数据。\n");
         initTestData();
@@ -1000,12 +5070,20 @@ int main() {
     }
 
     int choice;
+    expirySubscribe(expiryConsoleListener, NULL);
+    expirySubscribe(expiryLogListener, (void*)EXPIRY_LOG_FILE);
+    schedulerTick();
+
     while (1) {
+        schedulerTick();
+        dashboardTick();
         printMainMenu();
-        printf("请选择 (0-5): ");
-        if (scanf("%d", &choice) != 1) {
+        printf("请选择 (0-11): ");
+        int rc = inputInt(&choice);
+        if (rc == INPUT_EOF) {
+            choice = 0;     /* 输入结束（如管道脚本读完）按退出处理 */
+        } else if (rc != INPUT_OK) {
             printf("输入错误，请输入数字！\n");
-            clearInputBuffer();
             continue;
         }
 
@@ -1015,11 +5093,14 @@ int main() {
             case 2: {
                 int subChoice;
                 while (1) {
+                    schedulerTick();
+                    dashboardTick();
                     printManageMenu();
-                    printf("请选择 (0-4): ");
-                    if (scanf("%d", &subChoice) != 1) {
+                    printf("请选择 (0-5): ");
+                    int sub_rc = inputInt(&subChoice);
+                    if (sub_rc == INPUT_EOF) break;
+                    if (sub_rc != INPUT_OK) {
                         printf("输入错误，请输入数字！\n");
-                        clearInputBuffer();
                         continue;
                     }
                     if (subChoice == 0) break;
@@ -1029,6 +5110,7 @@ int main() {
                         case 2: updateMemberPhone(); break;
                         case 3: deleteExpiredMember(); break;
                         case 4: renewMember(); break;
+                        case 5: renewFromFile(); break;
                         default: printf("无效选项！\n");
                     }
                 }
@@ -1037,11 +5119,13 @@ int main() {
             case 3: {
                 int subChoice;
                 while (1) {
+                    schedulerTick();
                     printSearchMenu();
-                    printf("请选择 (0-2): ");
-                    if (scanf("%d", &subChoice) != 1) {
+                    printf("请选择 (0-3): ");
+                    int sub_rc = inputInt(&subChoice);
+                    if (sub_rc == INPUT_EOF) break;
+                    if (sub_rc != INPUT_OK) {
                         printf("输入错误，请输入数字！\n");
-                        clearInputBuffer();
                         continue;
                     }
                     if (subChoice == 0) break;
@@ -1049,6 +5133,7 @@ int main() {
                     switch (subChoice) {
                         case 1: searchByCardID(); break;
                         case 2: searchByName(); break;
+                        case 3: queryMembers(); break;
                         default: printf("无效选项！\n");
                     }
                 }
@@ -1056,6 +5141,12 @@ int main() {
 
             case 4: updateMemberStatus(); break;
             case 5: showStatistics(); break;
+            case 6: showMembersPaged(); break;
+            case 7: showSoonestExpiring(); break;
+            case 8: showRenewalReminders(); break;
+            case 9: showExpiryHistogram(); break;
+            case 10: exportData(); break;
+            case 11: toggleDashboard(); break;
 
             case 0:
                 saveToFile(DATA_FILE);